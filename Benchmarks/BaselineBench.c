@@ -0,0 +1,341 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * Handoff benchmark comparing Circular Buffers against the alternatives a
+ * program would otherwise use to move messages between two threads:
+ * - pipe(2);
+ * - a Unix domain socketpair(2);
+ * - a mutex-protected Circular Buffer whose consumer sleeps on an eventfd(2)
+ *   when the buffer is empty;
+ * - every ring variant in BenchRings, with both sides spinning.
+ * Kernel transports copy the message bytes; ring transports copy them into a
+ * preallocated message slot and pass its pointer, so every transport moves
+ * the same payload.
+ * For each transport the cost per message is reported both as wall-clock
+ * time and as CPU time consumed by the whole process (user and system), so
+ * spinning and sleeping approaches can be compared fairly.
+ * Build with:
+ *     gcc -O2 -pthread -o BaselineBench BaselineBench.c BenchUtils.c
+ *         BenchRings.c ../FCBuffer/FCBuffer.c
+ *         ../SPSCBuffer/SPSCBuffer.c
+ *         ../CircularBuffer/CircularBuffer.c
+ * Usage:
+ *     ./BaselineBench [-p producerCore] [-c consumerCore] [-n messages]
+ *                     [-m messageSize] [-s ringSize]
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "BenchRings.h"
+#include "BenchUtils.h"
+
+/* Transports compared; ring variants follow the kernel-based ones. */
+typedef enum {
+    TR_PIPE = 0,
+    TR_SOCKETPAIR,
+    TR_EVENTFD_QUEUE,
+    TR_RINGS        // First ring variant, BR_VARIANTS of them follow.
+} Transport;
+
+/* Benchmark configuration. */
+typedef struct {
+    int producerCore;
+    int consumerCore;
+    ulong messages;
+    ulong msgSize;
+    ulong ringSize;
+} BLConfig;
+
+/* State of a transport under test. */
+typedef struct {
+    int transport;
+    BLConfig *cfg;
+    int fds[2];                 // Pipe or socketpair ends.
+    CircBuffer *queue;          // eventfd-signalled queue.
+    pthread_mutex_t queueLock;
+    int eventFd;
+    BenchRing *ring;            // Ring variants.
+    char *pool;                 // Message slots for queue and rings.
+    ulong poolSlots;
+    uint64_t checksum;          // Sum of first and last message bytes.
+} BLState;
+
+/* Relaxes the CPU while spinning. */
+static inline void cpuRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/* Returns the name of a transport. */
+static const char *transportName(int transport) {
+    switch (transport) {
+        case TR_PIPE:
+            return "pipe";
+        case TR_SOCKETPAIR:
+            return "socketpair";
+        case TR_EVENTFD_QUEUE:
+            return "eventfd+mutex queue";
+        default:
+            return brName((BRVariant)(transport - TR_RINGS));
+    }
+}
+
+/* Writes a whole message to a file descriptor. */
+static int writeAll(int fd, const char *buf, ulong size) {
+    while (size > 0) {
+        ssize_t res = write(fd, buf, size);
+        if (res <= 0) return 0;
+        buf += res;
+        size -= (ulong)res;
+    }
+    return 1;
+}
+
+/* Reads a whole message from a file descriptor. */
+static int readAll(int fd, char *buf, ulong size) {
+    while (size > 0) {
+        ssize_t res = read(fd, buf, size);
+        if (res <= 0) return 0;
+        buf += res;
+        size -= (ulong)res;
+    }
+    return 1;
+}
+
+/* Sends a message through the eventfd-signalled queue. */
+static void queueSend(BLState *st, void *msg) {
+    for (;;) {
+        pthread_mutex_lock(&(st->queueLock));
+        int wasEmpty = st->queue->dataCount == 0;
+        int res = cbWrite(st->queue, msg);
+        pthread_mutex_unlock(&(st->queueLock));
+        if (res) {
+            if (wasEmpty) {
+                // Wake the consumer up, in case it's sleeping.
+                uint64_t one = 1;
+                if (write(st->eventFd, &one, sizeof(one)) < 0) return;
+            }
+            return;
+        }
+        sched_yield();  // Full queue.
+    }
+}
+
+/* Receives a message from the eventfd-signalled queue. */
+static void *queueReceive(BLState *st) {
+    for (;;) {
+        pthread_mutex_lock(&(st->queueLock));
+        void *msg = cbRead(st->queue);
+        pthread_mutex_unlock(&(st->queueLock));
+        if (msg != NULL) return msg;
+        // Empty queue: sleep until the producer signals.
+        uint64_t count;
+        if (read(st->eventFd, &count, sizeof(count)) < 0) return NULL;
+    }
+}
+
+/* Producer thread: sends all the messages. */
+static void *producerThread(void *arg) {
+    BLState *st = arg;
+    BLConfig *cfg = st->cfg;
+    if (!benchPinThread(cfg->producerCore))
+        fprintf(stderr, "Failed to pin producer to core %d\n",
+                cfg->producerCore);
+    char *local = malloc(cfg->msgSize);
+    if (local == NULL) return NULL;
+    for (ulong i = 0; i < cfg->messages; i++) {
+        char *msg = local;
+        if (st->pool != NULL)
+            msg = st->pool + (i % st->poolSlots) * cfg->msgSize;
+        memset(msg, (int)(i & 0xFF), cfg->msgSize);
+        switch (st->transport) {
+            case TR_PIPE:
+            case TR_SOCKETPAIR:
+                if (!writeAll(st->fds[1], msg, cfg->msgSize)) goto out;
+                break;
+            case TR_EVENTFD_QUEUE:
+                queueSend(st, msg);
+                break;
+            default:
+                while (!brWrite(st->ring, msg)) cpuRelax();
+                break;
+        }
+    }
+out:
+    free(local);
+    return NULL;
+}
+
+/* Consumer thread: receives all the messages, touching their bytes. */
+static void *consumerThread(void *arg) {
+    BLState *st = arg;
+    BLConfig *cfg = st->cfg;
+    if (!benchPinThread(cfg->consumerCore))
+        fprintf(stderr, "Failed to pin consumer to core %d\n",
+                cfg->consumerCore);
+    char *local = malloc(cfg->msgSize);
+    if (local == NULL) return NULL;
+    uint64_t sum = 0;
+    for (ulong i = 0; i < cfg->messages; i++) {
+        char *msg = local;
+        switch (st->transport) {
+            case TR_PIPE:
+            case TR_SOCKETPAIR:
+                if (!readAll(st->fds[0], local, cfg->msgSize)) goto out;
+                break;
+            case TR_EVENTFD_QUEUE:
+                msg = queueReceive(st);
+                if (msg == NULL) goto out;
+                break;
+            default:
+                while ((msg = brRead(st->ring)) == NULL) cpuRelax();
+                break;
+        }
+        sum += (uint64_t)(unsigned char)msg[0] +
+               (uint64_t)(unsigned char)msg[cfg->msgSize - 1];
+    }
+out:
+    st->checksum = sum;
+    free(local);
+    return NULL;
+}
+
+/* Sets up a transport. Returns 1 on success, 0 on failure. */
+static int setUp(BLState *st) {
+    st->fds[0] = st->fds[1] = st->eventFd = -1;
+    switch (st->transport) {
+        case TR_PIPE:
+            return pipe(st->fds) == 0;
+        case TR_SOCKETPAIR:
+            return socketpair(AF_UNIX, SOCK_STREAM, 0, st->fds) == 0;
+        case TR_EVENTFD_QUEUE:
+            st->queue = createCBuffer(st->cfg->ringSize);
+            st->eventFd = eventfd(0, 0);
+            pthread_mutex_init(&(st->queueLock), NULL);
+            break;
+        default:
+            st->ring = createBenchRing((BRVariant)(st->transport - TR_RINGS),
+                                       st->cfg->ringSize);
+            if (st->ring == NULL) return 0;
+            break;
+    }
+    if ((st->transport == TR_EVENTFD_QUEUE) &&
+        ((st->queue == NULL) || (st->eventFd < 0))) return 0;
+    // Message slots can be reused once twice the ring size later.
+    st->poolSlots = 2 * st->cfg->ringSize;
+    st->pool = malloc(st->poolSlots * st->cfg->msgSize);
+    return st->pool != NULL;
+}
+
+/* Tears down a transport. */
+static void tearDown(BLState *st) {
+    if (st->fds[0] >= 0) close(st->fds[0]);
+    if (st->fds[1] >= 0) close(st->fds[1]);
+    if (st->eventFd >= 0) close(st->eventFd);
+    if (st->queue != NULL) {
+        deleteCBuffer(st->queue, 0);
+        pthread_mutex_destroy(&(st->queueLock));
+    }
+    deleteBenchRing(st->ring);
+    free(st->pool);
+}
+
+/* Returns the CPU time consumed by the process so far, in nanoseconds. */
+static uint64_t cpuTimeNs(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+           1000000000ULL +
+           (uint64_t)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000;
+}
+
+int main(int argc, char **argv) {
+    BLConfig cfg = {0, 1, 1000000, 64, 1024};
+    int opt;
+    while ((opt = getopt(argc, argv, "p:c:n:m:s:")) != -1) {
+        switch (opt) {
+            case 'p':
+                cfg.producerCore = atoi(optarg);
+                break;
+            case 'c':
+                cfg.consumerCore = atoi(optarg);
+                break;
+            case 'n':
+                cfg.messages = strtoul(optarg, NULL, 10);
+                break;
+            case 'm':
+                cfg.msgSize = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                cfg.ringSize = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-p producerCore] "
+                        "[-c consumerCore] [-n messages] [-m messageSize] "
+                        "[-s ringSize]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if ((cfg.msgSize == 0) || (cfg.ringSize == 0)) {
+        fprintf(stderr, "Message and ring sizes must be positive\n");
+        exit(EXIT_FAILURE);
+    }
+    int prodSocket = benchCoreSocket(cfg.producerCore);
+    int consSocket = benchCoreSocket(cfg.consumerCore);
+    printf("producer: core %d (socket %d), consumer: core %d (socket %d)\n",
+           cfg.producerCore, prodSocket, cfg.consumerCore, consSocket);
+    printf("%lu messages of %lu bytes, ring size %lu\n", cfg.messages,
+           cfg.msgSize, cfg.ringSize);
+    printf("%-24s %12s %12s %8s\n", "transport", "wall ns/msg", "CPU ns/msg",
+           "CPUs");
+    // Every byte of message i is i & 0xFF: this is what consumers must sum.
+    uint64_t expected = 0;
+    for (ulong i = 0; i < cfg.messages; i++) expected += 2 * (i & 0xFF);
+    for (int t = 0; t < TR_RINGS + BR_VARIANTS; t++) {
+        BLState st;
+        memset(&st, 0, sizeof(st));
+        st.transport = t;
+        st.cfg = &cfg;
+        if (!setUp(&st)) {
+            fprintf(stderr, "Failed to set up %s\n", transportName(t));
+            tearDown(&st);
+            continue;
+        }
+        pthread_t prod, cons;
+        uint64_t cpuStart = cpuTimeNs();
+        uint64_t wallStart = benchNowNs();
+        pthread_create(&cons, NULL, consumerThread, &st);
+        pthread_create(&prod, NULL, producerThread, &st);
+        pthread_join(prod, NULL);
+        pthread_join(cons, NULL);
+        double wall = (double)(benchNowNs() - wallStart);
+        double cpu = (double)(cpuTimeNs() - cpuStart);
+        if (st.checksum != expected) {
+            fprintf(stderr, "%s: checksum mismatch, messages were lost or "
+                    "corrupted\n", transportName(t));
+            tearDown(&st);
+            exit(EXIT_FAILURE);
+        }
+        printf("%-24s %12.1f %12.1f %8.2f\n", transportName(t),
+               wall / (double)cfg.messages, cpu / (double)cfg.messages,
+               cpu / wall);
+        tearDown(&st);
+    }
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,308 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains the ring variants exercised by the benchmark programs.
+ * See the header file for a general description.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "BenchRings.h"
+
+// Number of Flat Combining slots each thread remembers.
+#define SLOT_CACHE 16
+
+// Variant names, as accepted on the command line.
+static const char *variantNames[BR_VARIANTS] = {"mutex", "spin", "cas",
+                                                "fc", "spsc"};
+
+// Unique ring ids.
+static ulong nextId = 1;
+
+// Flat Combining slots of the calling thread, by ring id.
+static __thread struct {
+    ulong id;
+    int slot;
+} slotCache[SLOT_CACHE];
+static __thread int slotCacheNext = 0;
+
+/* Creates a new CAS-based queue, rounding its size up to a power of two. */
+static BRCasQueue *_brCasCreate(ulong size) {
+    ulong cells = 2;
+    while (cells < size) cells <<= 1;
+    BRCasQueue *queue = aligned_alloc(64, sizeof(BRCasQueue));
+    if (queue == NULL) return NULL;
+    memset(queue, 0, sizeof(BRCasQueue));
+    queue->_cells = calloc(cells, sizeof(BRCasCell));
+    if (queue->_cells == NULL) {
+        free(queue);
+        return NULL;
+    }
+    for (ulong i = 0; i < cells; i++) queue->_cells[i]._seq = i;
+    queue->_mask = cells - 1;
+    return queue;
+}
+
+/* Enqueues an entry in a CAS-based queue. Returns 1 on success, 0 if full. */
+static int _brCasWrite(BRCasQueue *queue, void *data) {
+    BRCasCell *cell;
+    ulong pos = __atomic_load_n(&(queue->_enqueuePos), __ATOMIC_RELAXED);
+    for (;;) {
+        cell = queue->_cells + (pos & queue->_mask);
+        ulong seq = __atomic_load_n(&(cell->_seq), __ATOMIC_ACQUIRE);
+        long diff = (long)seq - (long)pos;
+        if (diff == 0) {
+            // The cell is free: try to claim it.
+            if (__atomic_compare_exchange_n(&(queue->_enqueuePos), &pos,
+                                            pos + 1, 1, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) break;
+        } else if (diff < 0) {
+            return 0;  // Full queue.
+        } else {
+            pos = __atomic_load_n(&(queue->_enqueuePos), __ATOMIC_RELAXED);
+        }
+    }
+    cell->_data = data;
+    __atomic_store_n(&(cell->_seq), pos + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Dequeues an entry from a CAS-based queue. Returns it, or NULL if empty. */
+static void *_brCasRead(BRCasQueue *queue) {
+    BRCasCell *cell;
+    ulong pos = __atomic_load_n(&(queue->_dequeuePos), __ATOMIC_RELAXED);
+    for (;;) {
+        cell = queue->_cells + (pos & queue->_mask);
+        ulong seq = __atomic_load_n(&(cell->_seq), __ATOMIC_ACQUIRE);
+        long diff = (long)seq - (long)(pos + 1);
+        if (diff == 0) {
+            // The cell is full: try to claim it.
+            if (__atomic_compare_exchange_n(&(queue->_dequeuePos), &pos,
+                                            pos + 1, 1, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) break;
+        } else if (diff < 0) {
+            return NULL;  // Empty queue.
+        } else {
+            pos = __atomic_load_n(&(queue->_dequeuePos), __ATOMIC_RELAXED);
+        }
+    }
+    void *data = cell->_data;
+    __atomic_store_n(&(cell->_seq), pos + queue->_mask + 1,
+                     __ATOMIC_RELEASE);
+    return data;
+}
+
+/* Returns the calling thread's Flat Combining slot for a ring, registering
+ * it on first use.
+ */
+static int _brSlot(BenchRing *bRing) {
+    for (int i = 0; i < SLOT_CACHE; i++)
+        if (slotCache[i].id == bRing->_id) return slotCache[i].slot;
+    int slot = fcRegister(bRing->_fc);
+    slotCache[slotCacheNext].id = bRing->_id;
+    slotCache[slotCacheNext].slot = slot;
+    slotCacheNext = (slotCacheNext + 1) % SLOT_CACHE;
+    return slot;
+}
+
+/* Creates a new ring of the given variant and size. */
+BenchRing *createBenchRing(BRVariant variant, ulong size) {
+    if (variant >= BR_VARIANTS) return NULL;  // Sanity check.
+    BenchRing *bRing = calloc(1, sizeof(BenchRing));
+    if (bRing == NULL) return NULL;  // calloc failed.
+    bRing->variant = variant;
+    bRing->_id = __atomic_fetch_add(&nextId, 1, __ATOMIC_RELAXED);
+    switch (variant) {
+        case BR_CAS:
+            bRing->_cas = _brCasCreate(size);
+            if (bRing->_cas == NULL) {
+                free(bRing);
+                return NULL;
+            }
+            break;
+        case BR_FC:
+            bRing->_fc = createFCBuffer(size, BR_MAX_THREADS);
+            if (bRing->_fc == NULL) {
+                free(bRing);
+                return NULL;
+            }
+            break;
+        case BR_SPSC:
+            bRing->_spsc = createSPSCBuffer(size, 0);
+            if (bRing->_spsc == NULL) {
+                free(bRing);
+                return NULL;
+            }
+            break;
+        default:
+            bRing->_ring = createCBuffer(size);
+            if (bRing->_ring == NULL) {
+                free(bRing);
+                return NULL;
+            }
+            pthread_mutex_init(&(bRing->_mutex), NULL);
+            pthread_spin_init(&(bRing->_spin), PTHREAD_PROCESS_PRIVATE);
+            break;
+    }
+    return bRing;
+}
+
+/* Deletes a ring. */
+void deleteBenchRing(BenchRing *bRing) {
+    if (bRing == NULL) return;
+    if (bRing->_cas != NULL) {
+        free(bRing->_cas->_cells);
+        free(bRing->_cas);
+    }
+    deleteFCBuffer(bRing->_fc, 0);
+    deleteSPSCBuffer(bRing->_spsc, 0);
+    if (bRing->_ring != NULL) {
+        pthread_mutex_destroy(&(bRing->_mutex));
+        pthread_spin_destroy(&(bRing->_spin));
+        deleteCBuffer(bRing->_ring, 0);
+    }
+    free(bRing);
+}
+
+/* Returns the name of a variant. */
+const char *brName(BRVariant variant) {
+    if (variant >= BR_VARIANTS) return "unknown";
+    return variantNames[variant];
+}
+
+/* Tells whether a variant only supports one producer and one consumer. */
+int brIsSPSC(BRVariant variant) {
+    return variant == BR_SPSC;
+}
+
+/* Returns the variant with the given name, or -1. */
+int brVariantByName(const char *name) {
+    for (int i = 0; i < BR_VARIANTS; i++)
+        if (strcmp(name, variantNames[i]) == 0) return i;
+    return -1;
+}
+
+/* Reads an entry from a ring. Returns the entry or NULL. */
+void *brRead(BenchRing *bRing) {
+    void *data = NULL;
+    switch (bRing->variant) {
+        case BR_MUTEX:
+            pthread_mutex_lock(&(bRing->_mutex));
+            data = cbRead(bRing->_ring);
+            pthread_mutex_unlock(&(bRing->_mutex));
+            break;
+        case BR_SPIN:
+            pthread_spin_lock(&(bRing->_spin));
+            data = cbRead(bRing->_ring);
+            pthread_spin_unlock(&(bRing->_spin));
+            break;
+        case BR_CAS:
+            data = _brCasRead(bRing->_cas);
+            break;
+        case BR_FC:
+            data = fcRead(bRing->_fc, _brSlot(bRing));
+            break;
+        case BR_SPSC:
+            data = spscRead(bRing->_spsc);
+            break;
+        default:
+            break;
+    }
+    return data;
+}
+
+/* Writes an entry in a ring. Returns 1 on success, 0 if the ring was full. */
+int brWrite(BenchRing *bRing, void *data) {
+    int res = 0;
+    switch (bRing->variant) {
+        case BR_MUTEX:
+            pthread_mutex_lock(&(bRing->_mutex));
+            res = cbWrite(bRing->_ring, data);
+            pthread_mutex_unlock(&(bRing->_mutex));
+            break;
+        case BR_SPIN:
+            pthread_spin_lock(&(bRing->_spin));
+            res = cbWrite(bRing->_ring, data);
+            pthread_spin_unlock(&(bRing->_spin));
+            break;
+        case BR_CAS:
+            res = _brCasWrite(bRing->_cas, data);
+            break;
+        case BR_FC:
+            res = fcWrite(bRing->_fc, _brSlot(bRing), data);
+            break;
+        case BR_SPSC:
+            res = spscWrite(bRing->_spsc, data);
+            break;
+        default:
+            break;
+    }
+    return res;
+}
+
+/* Reads a block of entries from a ring. Returns the number of entries. */
+ulong brCopy(BenchRing *bRing, void **dataBuf, ulong bufSize, int upTo) {
+    ulong res = 0;
+    switch (bRing->variant) {
+        case BR_MUTEX:
+            pthread_mutex_lock(&(bRing->_mutex));
+            res = cbCopy(bRing->_ring, dataBuf, bufSize, upTo);
+            pthread_mutex_unlock(&(bRing->_mutex));
+            break;
+        case BR_SPIN:
+            pthread_spin_lock(&(bRing->_spin));
+            res = cbCopy(bRing->_ring, dataBuf, bufSize, upTo);
+            pthread_spin_unlock(&(bRing->_spin));
+            break;
+        case BR_CAS:
+            while ((res < bufSize) &&
+                   ((dataBuf[res] = _brCasRead(bRing->_cas)) != NULL))
+                res++;
+            break;
+        case BR_FC:
+            res = fcCopy(bRing->_fc, _brSlot(bRing), dataBuf, bufSize, upTo);
+            break;
+        case BR_SPSC:
+            res = spscCopy(bRing->_spsc, dataBuf, bufSize, upTo);
+            break;
+        default:
+            break;
+    }
+    return res;
+}
+
+/* Writes a block of entries in a ring. Returns the number of entries. */
+ulong brPaste(BenchRing *bRing, void **dataBuf, ulong bufSize, int upTo) {
+    ulong res = 0;
+    switch (bRing->variant) {
+        case BR_MUTEX:
+            pthread_mutex_lock(&(bRing->_mutex));
+            res = cbPaste(bRing->_ring, dataBuf, bufSize, upTo);
+            pthread_mutex_unlock(&(bRing->_mutex));
+            break;
+        case BR_SPIN:
+            pthread_spin_lock(&(bRing->_spin));
+            res = cbPaste(bRing->_ring, dataBuf, bufSize, upTo);
+            pthread_spin_unlock(&(bRing->_spin));
+            break;
+        case BR_CAS:
+            while ((res < bufSize) && _brCasWrite(bRing->_cas, dataBuf[res]))
+                res++;
+            break;
+        case BR_FC:
+            res = fcPaste(bRing->_fc, _brSlot(bRing), dataBuf, bufSize,
+                          upTo);
+            break;
+        case BR_SPSC:
+            res = spscPaste(bRing->_spsc, dataBuf, bufSize, upTo);
+            break;
+        default:
+            break;
+    }
+    return res;
+}
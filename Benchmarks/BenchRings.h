@@ -0,0 +1,84 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains declarations for the ring variants exercised by the
+ * benchmark programs.
+ * The base Circular Buffer is not thread-safe, so when two threads share one
+ * it must be protected: each variant wraps a Circular Buffer with a different
+ * synchronization scheme, behind a single read/write interface, so the same
+ * benchmark loop can drive all of them.
+ * Next to the lock-based variants there are the Flat Combining Buffer, and
+ * a lock-free bounded MPMC queue based on compare-and-swap (D. Vyukov's
+ * design) used as the reference for CAS-based rings: it lives here since
+ * it's only meant for comparisons. Its bulk operations are just loops of
+ * single ones, and always behave as if "upTo" was set.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef BENCHRINGS_H
+#define BENCHRINGS_H
+
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "../CircularBuffer/CircularBuffer.h"
+#include "../FCBuffer/FCBuffer.h"
+#include "../SPSCBuffer/SPSCBuffer.h"
+
+// Maximum number of threads that can share a ring.
+#define BR_MAX_THREADS 256
+
+/* Available ring variants. */
+typedef enum {
+    BR_MUTEX = 0,   // Circular Buffer protected by a pthread mutex.
+    BR_SPIN,        // Circular Buffer protected by a pthread spinlock.
+    BR_CAS,         // Lock-free MPMC queue based on compare-and-swap.
+    BR_FC,          // Flat Combining Buffer.
+    BR_SPSC,        // SPSC Buffer (one producer, one consumer only).
+    BR_VARIANTS     // Number of variants.
+} BRVariant;
+
+/* A cell of the CAS-based queue, with its sequence number. */
+typedef struct {
+    ulong _seq;
+    void *_data;
+} BRCasCell;
+
+/* The CAS-based queue: a power-of-two array of cells, plus the enqueue and
+ * dequeue positions, on cache lines of their own.
+ */
+typedef struct {
+    BRCasCell *_cells;
+    ulong _mask;
+    ulong _enqueuePos __attribute__((aligned(64)));
+    ulong _dequeuePos __attribute__((aligned(64)));
+} BRCasQueue;
+
+/* A benchmark ring holds the state of its variant, and a unique id that
+ * threads use to remember their Flat Combining slots.
+ */
+typedef struct {
+    BRVariant variant;
+    ulong _id;
+    CircBuffer *_ring;
+    pthread_mutex_t _mutex;
+    pthread_spinlock_t _spin;
+    BRCasQueue *_cas;
+    FCBuffer *_fc;
+    SPSCBuffer *_spsc;
+} BenchRing;
+
+BenchRing *createBenchRing(BRVariant variant, ulong size);
+void deleteBenchRing(BenchRing *bRing);
+const char *brName(BRVariant variant);
+int brIsSPSC(BRVariant variant);
+int brVariantByName(const char *name);
+void *brRead(BenchRing *bRing);
+int brWrite(BenchRing *bRing, void *data);
+ulong brCopy(BenchRing *bRing, void **dataBuf, ulong bufSize, int upTo);
+ulong brPaste(BenchRing *bRing, void **dataBuf, ulong bufSize, int upTo);
+
+#endif
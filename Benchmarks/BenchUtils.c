@@ -0,0 +1,77 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains helper routines shared by the benchmark programs.
+ * See the header file for a general description.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#include "BenchUtils.h"
+
+// Timestamp counter ticks per nanosecond, set by benchCalibrate.
+static double ticksPerNs = 1.0;
+
+/* Measures the timestamp counter frequency against the monotonic clock.
+ * Must be called once before converting ticks.
+ */
+void benchCalibrate(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t startNs = benchNowNs(), startTicks = benchTicks();
+    uint64_t endNs;
+    do {
+        endNs = benchNowNs();
+    } while ((endNs - startNs) < 100000000ULL);  // 100 ms.
+    uint64_t endTicks = benchTicks();
+    ticksPerNs = (double)(endTicks - startTicks) / (double)(endNs - startNs);
+#else
+    ticksPerNs = 1.0;
+#endif
+}
+
+/* Converts a timestamp counter difference to nanoseconds. */
+double benchTicksToNs(uint64_t ticks) {
+    return (double)ticks / ticksPerNs;
+}
+
+/* Converts nanoseconds to timestamp counter ticks. */
+uint64_t benchNsToTicks(double ns) {
+    return (uint64_t)(ns * ticksPerNs);
+}
+
+/* Pins the calling thread to the given core. A negative core leaves the
+ * thread free to migrate.
+ * Returns 1 on success, 0 on failure.
+ */
+int benchPinThread(int core) {
+    if (core < 0) return 1;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+/* Returns the physical package (socket) the given core belongs to,
+ * or -1 if unknown.
+ */
+int benchCoreSocket(int core) {
+    if (core < 0) return -1;
+    char path[128];
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu%d/topology/physical_package_id",
+             core);
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return -1;
+    int socket = -1;
+    if (fscanf(f, "%d", &socket) != 1) socket = -1;
+    fclose(f);
+    return socket;
+}
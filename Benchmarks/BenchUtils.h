@@ -0,0 +1,51 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains declarations of helper routines shared by the benchmark
+ * programs: a cheap timestamp counter, its calibration against the system
+ * clock, and thread placement on given CPU cores.
+ * Benchmarks are standalone programs; see each one's header for how to
+ * build and run it.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef BENCHUTILS_H
+#define BENCHUTILS_H
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* Reads the timestamp counter (rdtsc on x86, the monotonic clock elsewhere).
+ * Use benchTicksToNs to convert differences to nanoseconds.
+ */
+static inline uint64_t benchTicks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* Reads the monotonic clock, in nanoseconds. */
+static inline uint64_t benchNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void benchCalibrate(void);
+double benchTicksToNs(uint64_t ticks);
+uint64_t benchNsToTicks(double ns);
+int benchPinThread(int core);
+int benchCoreSocket(int core);
+
+#endif
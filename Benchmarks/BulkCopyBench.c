@@ -0,0 +1,124 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * Throughput benchmark for parallel bulk transfers.
+ * A large buffer is filled with a single cbPasteBulk and drained with a
+ * single cbCopyBulk, starting from the middle of its data area so that the
+ * wrap is crossed, using copy pools of increasing size; 1 thread stands
+ * for the plain cbPaste and cbCopy. Bandwidth is reported in GB/s.
+ * Build with:
+ *     gcc -O2 -pthread -o BulkCopyBench BulkCopyBench.c BenchUtils.c
+ *         ../CircularBuffer/CircularBuffer.c
+ *         ../CircularBuffer/CircularBufferBulk.c
+ * Usage:
+ *     ./BulkCopyBench [-s bufferSize] [-t maxThreads] [-r rounds]
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../CircularBuffer/CircularBufferBulk.h"
+#include "BenchUtils.h"
+
+/* Runs the given number of rounds with a pool (NULL for no pool), and
+ * reports the best bandwidth seen for pastes and copies.
+ */
+static void runRounds(CBCopyPool *pool, CircBuffer *cBuff, void **src,
+                      void **dst, ulong rounds, double *pasteGBs,
+                      double *copyGBs) {
+    ulong size = cBuff->cbSize;
+    double bytes = (double)size * sizeof(void *);
+    *pasteGBs = 0.0;
+    *copyGBs = 0.0;
+    for (ulong r = 0; r < rounds; r++) {
+        uint64_t start = benchNowNs();
+        ulong pasted = cbPasteBulk(pool, cBuff, src, size, 0);
+        uint64_t mid = benchNowNs();
+        ulong copied = cbCopyBulk(pool, cBuff, dst, size, 0);
+        uint64_t end = benchNowNs();
+        if ((pasted != size) || (copied != size)) {
+            fprintf(stderr, "Transfer failed\n");
+            exit(EXIT_FAILURE);
+        }
+        double paste = bytes / (double)(mid - start);
+        double copy = bytes / (double)(end - mid);
+        if (paste > *pasteGBs) *pasteGBs = paste;
+        if (copy > *copyGBs) *copyGBs = copy;
+    }
+    // Check that the last round went through untouched.
+    for (ulong i = 0; i < size; i++) {
+        if (dst[i] != src[i]) {
+            fprintf(stderr, "Data mismatch at %lu\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    ulong size = 1UL << 27, rounds = 5;
+    long maxThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+    while ((opt = getopt(argc, argv, "s:t:r:")) != -1) {
+        switch (opt) {
+            case 's':
+                size = strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                maxThreads = atol(optarg);
+                break;
+            case 'r':
+                rounds = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-s bufferSize] [-t maxThreads] "
+                        "[-r rounds]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if ((size < 2) || (maxThreads < 1) || (rounds == 0)) {
+        fprintf(stderr, "Invalid arguments\n");
+        exit(EXIT_FAILURE);
+    }
+    CircBuffer *cBuff = createCBuffer(size);
+    void **src = malloc(size * sizeof(void *));
+    void **dst = malloc(size * sizeof(void *));
+    if ((cBuff == NULL) || (src == NULL) || (dst == NULL)) {
+        fprintf(stderr, "Allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    // Touch all memory, and move to the middle of the data area.
+    for (ulong i = 0; i < size; i++) src[i] = (void *)(uintptr_t)(i + 1);
+    cbPaste(cBuff, src, size, 0);
+    cbCopy(cBuff, dst, size / 2, 0);
+    cbCopy(cBuff, dst, size - size / 2, 0);
+    cbPaste(cBuff, src, size / 2, 0);
+    cbCopy(cBuff, dst, size / 2, 0);
+    printf("buffer size %lu (%.2f GB), best of %lu rounds\n", size,
+           (double)size * sizeof(void *) / 1e9, rounds);
+    printf("%8s %14s %14s\n", "threads", "paste GB/s", "copy GB/s");
+    for (long t = 1; t <= maxThreads; t = t < 2 ? 2 : t + 2) {
+        // The calling thread works too, so the pool needs one less.
+        CBCopyPool *pool = NULL;
+        if (t > 1) {
+            pool = createCBCopyPool((ulong)t - 1, 1);
+            if (pool == NULL) {
+                fprintf(stderr, "createCBCopyPool failed\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        double pasteGBs, copyGBs;
+        runRounds(pool, cBuff, src, dst, rounds, &pasteGBs, &copyGBs);
+        printf("%8ld %14.2f %14.2f\n", t, pasteGBs, copyGBs);
+        deleteCBCopyPool(pool);
+    }
+    deleteCBuffer(cBuff, 0);
+    free(src);
+    free(dst);
+    exit(EXIT_SUCCESS);
+}
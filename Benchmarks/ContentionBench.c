@@ -0,0 +1,172 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * Contention benchmark: many threads hammer a single shared ring.
+ * Every thread repeatedly writes an entry and then reads one, so the ring
+ * never fills up and all the cost comes from synchronization. Each variant
+ * in BenchRings (locks, compare-and-swap, flat combining) is run for a fixed
+ * time at each of the given thread counts, and the total throughput, in
+ * millions of write-read pairs per second, is reported. Variants that only
+ * support one producer and one consumer are skipped.
+ * Threads are pinned to cores round-robin, unless -u is given.
+ * Build with:
+ *     gcc -O2 -pthread -o ContentionBench ContentionBench.c BenchUtils.c
+ *         BenchRings.c ../FCBuffer/FCBuffer.c
+ *         ../SPSCBuffer/SPSCBuffer.c
+ *         ../CircularBuffer/CircularBuffer.c
+ * Usage:
+ *     ./ContentionBench [-t threadCounts] [-d durationMs] [-s ringSize]
+ *                       [-v variant] [-u]
+ * Thread counts are a comma-separated list, by default 1,2,4,8,16,32,64.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "BenchRings.h"
+#include "BenchUtils.h"
+
+/* State of a worker thread. */
+typedef struct {
+    BenchRing *ring;
+    int core;
+    volatile int *start;
+    volatile int *stop;
+    ulong pairs;
+    pthread_t tid;
+} Worker;
+
+/* Relaxes the CPU while spinning. */
+static inline void cpuRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/* Worker thread: writes and reads until told to stop. */
+static void *workerThread(void *arg) {
+    Worker *w = arg;
+    benchPinThread(w->core);
+    void *token = (void *)(uintptr_t)(w->core + 2);
+    while (!*(w->start)) cpuRelax();
+    ulong pairs = 0;
+    while (!*(w->stop)) {
+        while (!brWrite(w->ring, token)) cpuRelax();
+        while (brRead(w->ring) == NULL) cpuRelax();
+        pairs++;
+    }
+    w->pairs = pairs;
+    return NULL;
+}
+
+/* Runs a variant with the given number of threads.
+ * Returns the throughput in millions of pairs per second.
+ */
+static double run(BRVariant variant, int nThreads, ulong durationMs,
+                  ulong ringSize, int pin) {
+    BenchRing *ring = createBenchRing(variant, ringSize);
+    Worker *workers = calloc(nThreads, sizeof(Worker));
+    if ((ring == NULL) || (workers == NULL)) {
+        fprintf(stderr, "Allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    long nCores = sysconf(_SC_NPROCESSORS_ONLN);
+    volatile int start = 0, stop = 0;
+    for (int i = 0; i < nThreads; i++) {
+        workers[i].ring = ring;
+        workers[i].core = pin ? (int)(i % nCores) : -1;
+        workers[i].start = &start;
+        workers[i].stop = &stop;
+        pthread_create(&(workers[i].tid), NULL, workerThread, workers + i);
+    }
+    uint64_t t0 = benchNowNs();
+    __atomic_store_n(&start, 1, __ATOMIC_RELEASE);
+    usleep(durationMs * 1000);
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+    ulong pairs = 0;
+    for (int i = 0; i < nThreads; i++) {
+        pthread_join(workers[i].tid, NULL);
+        pairs += workers[i].pairs;
+    }
+    double elapsedNs = (double)(benchNowNs() - t0);
+    free(workers);
+    deleteBenchRing(ring);
+    return (double)pairs * 1000.0 / elapsedNs;
+}
+
+int main(int argc, char **argv) {
+    char defaultCounts[] = "1,2,4,8,16,32,64";
+    char *counts = defaultCounts;
+    ulong durationMs = 1000, ringSize = 1024;
+    int onlyVariant = -1, pin = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:d:s:v:u")) != -1) {
+        switch (opt) {
+            case 't':
+                counts = optarg;
+                break;
+            case 'd':
+                durationMs = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                ringSize = strtoul(optarg, NULL, 10);
+                break;
+            case 'v':
+                onlyVariant = brVariantByName(optarg);
+                if (onlyVariant < 0) {
+                    fprintf(stderr, "Unknown variant: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'u':
+                pin = 0;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-t threadCounts] "
+                        "[-d durationMs] [-s ringSize] [-v variant] [-u]\n",
+                        argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    // Parse the thread counts.
+    int threadCounts[64];
+    int nCounts = 0;
+    for (char *tok = strtok(counts, ","); (tok != NULL) && (nCounts < 64);
+         tok = strtok(NULL, ",")) {
+        int n = atoi(tok);
+        if ((n <= 0) || (n > BR_MAX_THREADS) || ((ulong)n > ringSize)) {
+            fprintf(stderr, "Thread counts must be between 1 and %d, and "
+                    "not larger than the ring size\n", BR_MAX_THREADS);
+            exit(EXIT_FAILURE);
+        }
+        threadCounts[nCounts++] = n;
+    }
+    printf("Throughput (M write-read pairs/s), ring size %lu, %lu ms per "
+           "point\n%-8s", ringSize, durationMs, "threads");
+    for (int v = 0; v < BR_VARIANTS; v++)
+        if (((onlyVariant < 0) || (v == onlyVariant)) && !brIsSPSC(v))
+            printf(" %10s", brName(v));
+    printf("\n");
+    for (int c = 0; c < nCounts; c++) {
+        printf("%-8d", threadCounts[c]);
+        for (int v = 0; v < BR_VARIANTS; v++) {
+            if ((onlyVariant >= 0) && (v != onlyVariant)) continue;
+            if (brIsSPSC(v)) continue;
+            printf(" %10.3f", run((BRVariant)v, threadCounts[c], durationMs,
+                                  ringSize, pin));
+            fflush(stdout);
+        }
+        printf("\n");
+    }
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,177 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * Loopback UDP benchmark for batched datagram transfers.
+ * Datagrams queued in a Circular Buffer of descriptors are sent to, and
+ * received from, a pair of loopback UDP sockets, in bursts, either one
+ * datagram per system call (send/recv) or in batches with
+ * cbSendMMsg/cbRecvMMsg. Time and system calls per datagram are reported;
+ * the latter are the calls actually made, including short and empty ones.
+ * Build with:
+ *     gcc -O2 -o DatagramBench DatagramBench.c BenchUtils.c
+ *         ../CircularBuffer/CircularBuffer.c
+ *         ../CircularBuffer/CircularBufferMsg.c
+ * Usage:
+ *     ./DatagramBench [-n datagrams] [-m datagramSize] [-b burstSize]
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../CircularBuffer/CircularBufferMsg.h"
+#include "BenchUtils.h"
+
+/* Opens a UDP socket bound to an ephemeral loopback port. */
+static int openSocket(struct sockaddr_in *addr) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return -1;
+    int bufSize = 8 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufSize, sizeof(bufSize));
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(*addr);
+    if ((bind(fd, (struct sockaddr *)addr, sizeof(*addr)) != 0) ||
+        (getsockname(fd, (struct sockaddr *)addr, &len) != 0)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char **argv) {
+    ulong total = 1000000, size = 64, burst = 256;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:m:b:")) != -1) {
+        switch (opt) {
+            case 'n':
+                total = strtoul(optarg, NULL, 10);
+                break;
+            case 'm':
+                size = strtoul(optarg, NULL, 10);
+                break;
+            case 'b':
+                burst = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n datagrams] [-m datagramSize] "
+                        "[-b burstSize]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if ((size == 0) || (size > 65507) || (burst == 0)) {
+        fprintf(stderr, "Invalid datagram or burst size\n");
+        exit(EXIT_FAILURE);
+    }
+    struct sockaddr_in txAddr, rxAddr;
+    int txFd = openSocket(&txAddr), rxFd = openSocket(&rxAddr);
+    if ((txFd < 0) || (rxFd < 0) ||
+        (connect(txFd, (struct sockaddr *)&rxAddr, sizeof(rxAddr)) != 0)) {
+        perror("socket setup");
+        exit(EXIT_FAILURE);
+    }
+    // Descriptors and their payloads, plus the queues they move through.
+    CBDatagram *dgrams = calloc(burst, sizeof(CBDatagram));
+    char *payloads = calloc(burst, size);
+    void **freeDescs = malloc(burst * sizeof(void *));
+    CircBuffer *txQueue = createCBuffer(burst);
+    CircBuffer *rxQueue = createCBuffer(burst);
+    if ((dgrams == NULL) || (payloads == NULL) || (freeDescs == NULL) ||
+        (txQueue == NULL) || (rxQueue == NULL)) {
+        fprintf(stderr, "Allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (ulong i = 0; i < burst; i++) {
+        dgrams[i].data = payloads + i * size;
+        dgrams[i].len = size;
+        dgrams[i].capacity = size;
+        freeDescs[i] = dgrams + i;
+    }
+    printf("%lu datagrams of %lu bytes, bursts of %lu, loopback UDP\n",
+           total, size, burst);
+    for (int batched = 0; batched < 2; batched++) {
+        ulong moved = 0, syscalls = 0;
+        uint64_t start = benchNowNs();
+        while (moved < total) {
+            ulong n = (total - moved) < burst ? (total - moved) : burst;
+            // Queue a burst (to the connected peer), then send it.
+            for (ulong i = 0; i < n; i++)
+                ((CBDatagram *)freeDescs[i])->addrLen = 0;
+            cbPaste(txQueue, freeDescs, n, 0);
+            if (batched) {
+                ulong sent = 0;
+                while (sent < n) {
+                    ulong calls;
+                    ulong res = cbSendMMsg(txQueue, txFd, n - sent, 0,
+                                           freeDescs + sent, &calls);
+                    syscalls += calls;
+                    if (res == 0) {
+                        perror("cbSendMMsg");
+                        exit(EXIT_FAILURE);
+                    }
+                    sent += res;
+                }
+            } else {
+                for (ulong i = 0; i < n; i++) {
+                    CBDatagram *dgram = cbRead(txQueue);
+                    syscalls++;
+                    if (send(txFd, dgram->data, dgram->len, 0) < 0) {
+                        perror("send");
+                        exit(EXIT_FAILURE);
+                    }
+                    freeDescs[i] = dgram;
+                }
+            }
+            // Receive the burst back into the other queue, then drain it.
+            ulong received = 0;
+            while (received < n) {
+                if (batched) {
+                    ulong calls;
+                    ulong res = cbRecvMMsg(rxQueue, rxFd, freeDescs + received,
+                                           n - received, 0, NULL, &calls);
+                    syscalls += calls;
+                    if (res == 0) {
+                        perror("cbRecvMMsg");
+                        exit(EXIT_FAILURE);
+                    }
+                    received += res;
+                } else {
+                    CBDatagram *dgram = freeDescs[received];
+                    ssize_t res = recv(rxFd, dgram->data, dgram->capacity, 0);
+                    syscalls++;
+                    if (res < 0) {
+                        perror("recv");
+                        exit(EXIT_FAILURE);
+                    }
+                    dgram->len = (size_t)res;
+                    cbWrite(rxQueue, dgram);
+                    received++;
+                }
+            }
+            cbCopy(rxQueue, freeDescs, received, 1);
+            moved += n;
+        }
+        double ns = (double)(benchNowNs() - start);
+        printf("%-28s %8.1f ns/datagram %8.3f syscalls/datagram\n",
+               batched ? "cbSendMMsg/cbRecvMMsg" : "send/recv, one per call",
+               ns / (double)total, (double)syscalls / (double)total);
+    }
+    close(txFd);
+    close(rxFd);
+    deleteCBuffer(txQueue, 0);
+    deleteCBuffer(rxQueue, 0);
+    free(freeDescs);
+    free(payloads);
+    free(dgrams);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,132 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage the latency histogram.
+ * See the header file for a general description of the structure.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "LatencyHistogram.h"
+
+// Each power of two is split in (1 << (SUB_BITS - 1)) linear sub-buckets.
+#define SUB_BITS 11
+#define SUB_COUNT (1ULL << SUB_BITS)
+#define HALF_COUNT (SUB_COUNT >> 1)
+#define MAX_SHIFT (64 - SUB_BITS + 1)
+
+/* Returns the bucket a value falls into. */
+static inline uint64_t _lhIndex(uint64_t value) {
+    if (value < SUB_COUNT) return value;
+    uint64_t shift = (uint64_t)(64 - __builtin_clzll(value)) - SUB_BITS;
+    return shift * HALF_COUNT + (value >> shift);
+}
+
+/* Returns the highest value that falls into a bucket. */
+static inline uint64_t _lhValue(uint64_t index) {
+    if (index < SUB_COUNT) return index;
+    uint64_t shift = (index / HALF_COUNT) - 1;
+    uint64_t sub = index - shift * HALF_COUNT;
+    return ((sub + 1) << shift) - 1;
+}
+
+/* Creates a new, empty histogram. */
+LatencyHistogram *createLHistogram(void) {
+    LatencyHistogram *hist = calloc(1, sizeof(LatencyHistogram));
+    if (hist == NULL) return NULL;  // calloc failed.
+    hist->_nBuckets = MAX_SHIFT * HALF_COUNT + SUB_COUNT;
+    hist->_counts = calloc(hist->_nBuckets, sizeof(uint64_t));
+    if (hist->_counts == NULL) {
+        // calloc failed.
+        free(hist);
+        return NULL;
+    }
+    lhReset(hist);
+    return hist;
+}
+
+/* Deletes a histogram. */
+void deleteLHistogram(LatencyHistogram *hist) {
+    if (hist == NULL) return;
+    free(hist->_counts);
+    free(hist);
+}
+
+/* Clears all the values recorded in a histogram. */
+void lhReset(LatencyHistogram *hist) {
+    if (hist == NULL) return;
+    memset(hist->_counts, 0, hist->_nBuckets * sizeof(uint64_t));
+    hist->totalCount = 0;
+    hist->minValue = UINT64_MAX;
+    hist->maxValue = 0;
+}
+
+/* Records a value. */
+void lhRecord(LatencyHistogram *hist, uint64_t value) {
+    if (hist == NULL) return;
+    hist->_counts[_lhIndex(value)]++;
+    hist->totalCount++;
+    if (value < hist->minValue) hist->minValue = value;
+    if (value > hist->maxValue) hist->maxValue = value;
+}
+
+/* Records a value, correcting for coordinated omission: if the value exceeds
+ * the expected interval between measurements, the values that the measuring
+ * side would have seen had it not been stalled are recorded too.
+ * An expected interval of 0 disables the correction.
+ */
+void lhRecordCorrected(LatencyHistogram *hist, uint64_t value,
+                       uint64_t expectedInterval) {
+    lhRecord(hist, value);
+    if ((expectedInterval == 0) || (value <= expectedInterval)) return;
+    for (uint64_t missed = value - expectedInterval;
+         missed >= expectedInterval; missed -= expectedInterval)
+        lhRecord(hist, missed);
+}
+
+/* Adds all the values recorded in a histogram to another one. */
+void lhMerge(LatencyHistogram *dst, LatencyHistogram *src) {
+    if ((dst == NULL) || (src == NULL)) return;
+    for (uint64_t i = 0; i < src->_nBuckets; i++)
+        dst->_counts[i] += src->_counts[i];
+    dst->totalCount += src->totalCount;
+    if (src->minValue < dst->minValue) dst->minValue = src->minValue;
+    if (src->maxValue > dst->maxValue) dst->maxValue = src->maxValue;
+}
+
+/* Returns the value below which the given percentage (0 to 100) of the
+ * recorded values fall, or 0 if the histogram is empty.
+ */
+uint64_t lhPercentile(LatencyHistogram *hist, double percentile) {
+    if ((hist == NULL) || (hist->totalCount == 0)) return 0;
+    if (percentile >= 100.0) return hist->maxValue;
+    uint64_t target = (uint64_t)((percentile / 100.0) *
+                                 (double)hist->totalCount + 0.5);
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (uint64_t i = 0; i < hist->_nBuckets; i++) {
+        seen += hist->_counts[i];
+        if (seen >= target) {
+            uint64_t value = _lhValue(i);
+            return value > hist->maxValue ? hist->maxValue : value;
+        }
+    }
+    return hist->maxValue;
+}
+
+/* Prints a one-line summary of a histogram. */
+void lhPrint(LatencyHistogram *hist, const char *label, FILE *out) {
+    if ((hist == NULL) || (out == NULL)) return;
+    fprintf(out, "%-24s n=%-10lu min=%-8lu p50=%-8lu p99=%-8lu p99.9=%-8lu "
+            "max=%lu\n", label, (unsigned long)hist->totalCount,
+            (unsigned long)(hist->totalCount ? hist->minValue : 0),
+            (unsigned long)lhPercentile(hist, 50.0),
+            (unsigned long)lhPercentile(hist, 99.0),
+            (unsigned long)lhPercentile(hist, 99.9),
+            (unsigned long)hist->maxValue);
+}
@@ -0,0 +1,44 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for a latency
+ * histogram in the style of HdrHistogram, used by the benchmark programs.
+ * Values (usually nanoseconds) are counted in buckets whose width grows with
+ * the value's magnitude: each power of two is split in a fixed number of
+ * linear sub-buckets, so relative precision is constant (about 0.1%) over
+ * the whole range, while recording stays O(1) and memory stays bounded.
+ * Recording can be corrected for coordinated omission: when a measurement
+ * took longer than the expected interval between two measurements, the
+ * samples that a stalled sender would have missed are filled in.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* A histogram is made of its bucket counters, plus a few summary values. */
+typedef struct {
+    uint64_t *_counts;
+    uint64_t _nBuckets;
+    uint64_t totalCount;
+    uint64_t minValue;
+    uint64_t maxValue;
+} LatencyHistogram;
+
+LatencyHistogram *createLHistogram(void);
+void deleteLHistogram(LatencyHistogram *hist);
+void lhReset(LatencyHistogram *hist);
+void lhRecord(LatencyHistogram *hist, uint64_t value);
+void lhRecordCorrected(LatencyHistogram *hist, uint64_t value,
+                       uint64_t expectedInterval);
+void lhMerge(LatencyHistogram *dst, LatencyHistogram *src);
+uint64_t lhPercentile(LatencyHistogram *hist, double percentile);
+void lhPrint(LatencyHistogram *hist, const char *label, FILE *out);
+
+#endif
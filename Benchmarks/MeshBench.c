@@ -0,0 +1,204 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * Mesh benchmark: many producers send messages to many consumers.
+ * Half of the threads are producers and half are consumers. They exchange
+ * messages either through a Channel Mesh, i.e. one SPSC Buffer per pair, or
+ * through the single shared lock-free MPMC queue from BenchRings, for a
+ * fixed time at each of the given thread counts. The total throughput, in
+ * millions of messages received per second, is reported.
+ * Messages are sent and received in batches of the given size (1 by
+ * default, i.e. one entry at a time).
+ * Threads are pinned to cores round-robin, unless -u is given.
+ * Build with:
+ *     gcc -O2 -pthread -o MeshBench MeshBench.c BenchUtils.c
+ *         BenchRings.c ../FCBuffer/FCBuffer.c
+ *         ../ChannelMesh/ChannelMesh.c
+ *         ../SPSCBuffer/SPSCBuffer.c
+ *         ../CircularBuffer/CircularBuffer.c
+ * Usage:
+ *     ./MeshBench [-t threadCounts] [-d durationMs] [-s ringSize]
+ *                 [-b batch] [-u]
+ * Thread counts are a comma-separated list of even numbers, by default
+ * 8,16,32,64. The ring size is that of each buffer of the mesh; the shared
+ * queue gets as many entries as the whole mesh.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../ChannelMesh/ChannelMesh.h"
+#include "BenchRings.h"
+#include "BenchUtils.h"
+
+// Largest batch size.
+#define MAX_BATCH 256
+
+/* State of a worker thread. */
+typedef struct {
+    ChannelMesh *mesh;
+    BenchRing *ring;
+    ulong index;
+    int producer;
+    ulong batch;
+    int core;
+    volatile int *start;
+    volatile int *stop;
+    ulong msgs;
+    pthread_t tid;
+} Worker;
+
+/* Relaxes the CPU while spinning. */
+static inline void cpuRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/* Worker thread: sends or receives batches until told to stop. */
+static void *workerThread(void *arg) {
+    Worker *w = arg;
+    void *batch[MAX_BATCH];
+    benchPinThread(w->core);
+    for (ulong i = 0; i < w->batch; i++)
+        batch[i] = (void *)(uintptr_t)(w->index + i + 1);
+    while (!*(w->start)) cpuRelax();
+    ulong msgs = 0, done;
+    while (!*(w->stop)) {
+        if (w->producer) {
+            done = w->mesh != NULL ?
+                   cmPaste(w->mesh, w->index, batch, w->batch) :
+                   brPaste(w->ring, batch, w->batch, 1);
+        } else {
+            done = w->mesh != NULL ?
+                   cmCopy(w->mesh, w->index, batch, w->batch) :
+                   brCopy(w->ring, batch, w->batch, 1);
+        }
+        if (done == 0) cpuRelax();
+        msgs += done;
+    }
+    w->msgs = w->producer ? 0 : msgs;
+    return NULL;
+}
+
+/* Runs with the given number of threads, through a mesh or the shared
+ * queue.
+ * Returns the throughput in millions of messages per second.
+ */
+static double run(int useMesh, int nThreads, ulong durationMs,
+                  ulong ringSize, ulong batch, int pin) {
+    ulong half = (ulong)nThreads / 2;
+    ChannelMesh *mesh = NULL;
+    BenchRing *ring = NULL;
+    if (useMesh) mesh = createChannelMesh(half, half, ringSize);
+    else ring = createBenchRing(BR_CAS, ringSize * half * half);
+    Worker *workers = calloc(nThreads, sizeof(Worker));
+    if (((mesh == NULL) && (ring == NULL)) || (workers == NULL)) {
+        fprintf(stderr, "Allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    long nCores = sysconf(_SC_NPROCESSORS_ONLN);
+    volatile int start = 0, stop = 0;
+    for (int i = 0; i < nThreads; i++) {
+        workers[i].mesh = mesh;
+        workers[i].ring = ring;
+        workers[i].producer = (ulong)i < half;
+        workers[i].index = (ulong)i < half ? (ulong)i : (ulong)i - half;
+        workers[i].batch = batch;
+        workers[i].core = pin ? (int)(i % nCores) : -1;
+        workers[i].start = &start;
+        workers[i].stop = &stop;
+        pthread_create(&(workers[i].tid), NULL, workerThread, workers + i);
+    }
+    uint64_t t0 = benchNowNs();
+    __atomic_store_n(&start, 1, __ATOMIC_RELEASE);
+    usleep(durationMs * 1000);
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+    ulong msgs = 0;
+    for (int i = 0; i < nThreads; i++) {
+        pthread_join(workers[i].tid, NULL);
+        msgs += workers[i].msgs;
+    }
+    double elapsedNs = (double)(benchNowNs() - t0);
+    free(workers);
+    deleteChannelMesh(mesh, 0);
+    if (ring != NULL) deleteBenchRing(ring);
+    return (double)msgs * 1000.0 / elapsedNs;
+}
+
+int main(int argc, char **argv) {
+    char defaultCounts[] = "8,16,32,64";
+    char *counts = defaultCounts;
+    ulong durationMs = 1000, ringSize = 256, batch = 1;
+    int pin = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:d:s:b:u")) != -1) {
+        switch (opt) {
+            case 't':
+                counts = optarg;
+                break;
+            case 'd':
+                durationMs = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                ringSize = strtoul(optarg, NULL, 10);
+                break;
+            case 'b':
+                batch = strtoul(optarg, NULL, 10);
+                if ((batch == 0) || (batch > MAX_BATCH)) {
+                    fprintf(stderr, "Batch size must be between 1 and %d\n",
+                            MAX_BATCH);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'u':
+                pin = 0;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-t threadCounts] "
+                        "[-d durationMs] [-s ringSize] [-b batch] [-u]\n",
+                        argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (ringSize == 0) {
+        fprintf(stderr, "Ring size must be positive\n");
+        exit(EXIT_FAILURE);
+    }
+    // Parse the thread counts.
+    int threadCounts[64];
+    int nCounts = 0;
+    for (char *tok = strtok(counts, ","); (tok != NULL) && (nCounts < 64);
+         tok = strtok(NULL, ",")) {
+        int n = atoi(tok);
+        if ((n < 2) || (n > BR_MAX_THREADS) || ((n % 2) != 0)) {
+            fprintf(stderr, "Thread counts must be even, between 2 and %d\n",
+                    BR_MAX_THREADS);
+            exit(EXIT_FAILURE);
+        }
+        threadCounts[nCounts++] = n;
+    }
+    printf("Throughput (M messages/s), ring size %lu, batch %lu, %lu ms per "
+           "point\n%-8s %10s %10s\n", ringSize, batch, durationMs, "threads",
+           "mesh", brName(BR_CAS));
+    for (int c = 0; c < nCounts; c++) {
+        printf("%-8d", threadCounts[c]);
+        printf(" %10.3f", run(1, threadCounts[c], durationMs, ringSize, batch,
+                              pin));
+        fflush(stdout);
+        printf(" %10.3f\n", run(0, threadCounts[c], durationMs, ringSize,
+                                batch, pin));
+        fflush(stdout);
+    }
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,168 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * Single-thread throughput benchmark for the four Circular Buffer data
+ * operations: cbWrite, cbRead, cbCopy and cbPaste.
+ * Each operation is run over and over on a buffer that is filled or drained
+ * outside of the measured region, and its cost is reported as nanoseconds
+ * and millions of entries per second, together with the hardware counters
+ * (per operation call) that could be opened; see PerfCounters.h.
+ * Build with:
+ *     gcc -O2 -pthread -o OpsBench OpsBench.c BenchUtils.c PerfCounters.c
+ *         ../CircularBuffer/CircularBuffer.c
+ * Usage:
+ *     ./OpsBench [-c core] [-s bufferSize] [-b batchSize] [-r rounds]
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../CircularBuffer/CircularBuffer.h"
+#include "BenchUtils.h"
+#include "PerfCounters.h"
+
+/* Operations measured. */
+typedef enum {
+    OP_WRITE = 0,
+    OP_READ,
+    OP_COPY,
+    OP_PASTE,
+    OP_COUNT
+} BenchOp;
+
+static const char *opNames[OP_COUNT] = {"cbWrite", "cbRead", "cbCopy",
+                                        "cbPaste"};
+
+/* Fills a buffer up, outside of the measured region. */
+static void fillUp(CircBuffer *cBuff, void **src) {
+    cbPaste(cBuff, src, cBuff->cbSize - cBuff->dataCount, 1);
+}
+
+/* Drains a buffer, outside of the measured region. */
+static void drain(CircBuffer *cBuff, void **dst) {
+    while (cbCopy(cBuff, dst, cBuff->cbSize, 1) != 0);
+}
+
+/* Runs an operation for the given number of rounds, each of which moves a
+ * whole buffer's worth of entries.
+ * Returns the number of calls made; time and counters are accumulated.
+ */
+static ulong runOp(BenchOp op, CircBuffer *cBuff, void **src, void **dst,
+                   ulong batch, ulong rounds, PerfCounters *pCount,
+                   uint64_t *ticks) {
+    ulong calls = 0;
+    ulong size = cBuff->cbSize;
+    // Start from half a buffer, so that wrap-arounds are exercised too.
+    drain(cBuff, dst);
+    cbPaste(cBuff, src, size / 2, 1);
+    cbCopy(cBuff, dst, size / 2, 1);
+    for (ulong r = 0; r < rounds; r++) {
+        if ((op == OP_READ) || (op == OP_COPY)) fillUp(cBuff, src);
+        else drain(cBuff, dst);
+        pcEnable(pCount);
+        uint64_t start = benchTicks();
+        switch (op) {
+            case OP_WRITE:
+                for (ulong i = 0; i < size; i++)
+                    cbWrite(cBuff, src[i]);
+                calls += size;
+                break;
+            case OP_READ:
+                for (ulong i = 0; i < size; i++)
+                    dst[i] = cbRead(cBuff);
+                calls += size;
+                break;
+            case OP_COPY:
+                for (ulong i = 0; i + batch <= size; i += batch)
+                    cbCopy(cBuff, dst + i, batch, 0);
+                calls += size / batch;
+                break;
+            case OP_PASTE:
+                for (ulong i = 0; i + batch <= size; i += batch)
+                    cbPaste(cBuff, src + i, batch, 0);
+                calls += size / batch;
+                break;
+            default:
+                break;
+        }
+        *ticks += benchTicks() - start;
+        pcDisable(pCount);
+    }
+    return calls;
+}
+
+int main(int argc, char **argv) {
+    int core = -1;
+    ulong size = 4096, batch = 16, rounds = 2000;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:s:b:r:")) != -1) {
+        switch (opt) {
+            case 'c':
+                core = atoi(optarg);
+                break;
+            case 's':
+                size = strtoul(optarg, NULL, 10);
+                break;
+            case 'b':
+                batch = strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                rounds = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-c core] [-s bufferSize] "
+                        "[-b batchSize] [-r rounds]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if ((size == 0) || (batch == 0) || (batch > size)) {
+        fprintf(stderr, "Batch size must be between 1 and buffer size\n");
+        exit(EXIT_FAILURE);
+    }
+    if (!benchPinThread(core))
+        fprintf(stderr, "Failed to pin to core %d\n", core);
+    benchCalibrate();
+    CircBuffer *cBuff = createCBuffer(size);
+    void **src = malloc(size * sizeof(void *));
+    void **dst = malloc(size * sizeof(void *));
+    PerfCounters *pCount = createPerfCounters();
+    if ((cBuff == NULL) || (src == NULL) || (dst == NULL) ||
+        (pCount == NULL)) {
+        fprintf(stderr, "Allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (ulong i = 0; i < size; i++) src[i] = (void *)(uintptr_t)(i + 1);
+    int anyCounter = 0;
+    for (int e = 0; e < PC_EVENTS; e++)
+        anyCounter |= pcAvailable(pCount, (PCEvent)e);
+    if (!anyCounter)
+        fprintf(stderr, "No hardware counters available, "
+                "reporting timings only\n");
+    printf("buffer size %lu, batch size %lu, %lu rounds\n", size, batch,
+           rounds);
+    for (int op = 0; op < OP_COUNT; op++) {
+        uint64_t ticks = 0;
+        pcReset(pCount);
+        ulong calls = runOp((BenchOp)op, cBuff, src, dst, batch, rounds,
+                            pCount, &ticks);
+        pcRead(pCount);
+        ulong entries = ((op == OP_COPY) || (op == OP_PASTE)) ?
+                        calls * batch : calls;
+        double ns = benchTicksToNs(ticks);
+        printf("%-8s %8.2f ns/call %9.2f Mentries/s\n", opNames[op],
+               ns / (double)calls, (double)entries * 1000.0 / ns);
+        printf("%-8s per call:", "");
+        pcPrintPerOp(pCount, calls, stdout);
+    }
+    deletePerfCounters(pCount);
+    deleteCBuffer(cBuff, 0);
+    free(src);
+    free(dst);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,146 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage hardware performance counters.
+ * See the header file for a general description.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#define _GNU_SOURCE
+
+#include <linux/perf_event.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "PerfCounters.h"
+
+// Counter names, as printed in reports.
+static const char *eventNames[PC_EVENTS] = {
+    "cycles", "instructions", "L1D-misses", "LLC-misses", "branch-misses",
+    "HITM"
+};
+
+/* Opens a counter for the calling thread. Returns its fd or -1. */
+static int _pcOpen(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/* Creates a new counter set, opening every available counter. */
+PerfCounters *createPerfCounters(void) {
+    PerfCounters *pCount = calloc(1, sizeof(PerfCounters));
+    if (pCount == NULL) return NULL;  // calloc failed.
+    pCount->_fds[PC_CYCLES] = _pcOpen(PERF_TYPE_HARDWARE,
+                                      PERF_COUNT_HW_CPU_CYCLES);
+    pCount->_fds[PC_INSTRUCTIONS] = _pcOpen(PERF_TYPE_HARDWARE,
+                                            PERF_COUNT_HW_INSTRUCTIONS);
+    pCount->_fds[PC_L1D_MISSES] = _pcOpen(PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    pCount->_fds[PC_LLC_MISSES] = _pcOpen(PERF_TYPE_HARDWARE,
+                                          PERF_COUNT_HW_CACHE_MISSES);
+    pCount->_fds[PC_BRANCH_MISSES] = _pcOpen(PERF_TYPE_HARDWARE,
+                                             PERF_COUNT_HW_BRANCH_MISSES);
+    pCount->_fds[PC_HITM] = -1;
+    char *hitm = getenv("CB_PERF_HITM");
+    if (hitm != NULL)
+        pCount->_fds[PC_HITM] = _pcOpen(PERF_TYPE_RAW,
+                                        strtoull(hitm, NULL, 0));
+    pcReset(pCount);
+    return pCount;
+}
+
+/* Deletes a counter set, closing its counters. */
+void deletePerfCounters(PerfCounters *pCount) {
+    if (pCount == NULL) return;
+    for (int i = 0; i < PC_EVENTS; i++)
+        if (pCount->_fds[i] >= 0) close(pCount->_fds[i]);
+    free(pCount);
+}
+
+/* Tells whether a counter could be opened. */
+int pcAvailable(PerfCounters *pCount, PCEvent event) {
+    if ((pCount == NULL) || (event >= PC_EVENTS)) return 0;
+    return pCount->_fds[event] >= 0;
+}
+
+/* Returns the name of a counter. */
+const char *pcName(PCEvent event) {
+    if (event >= PC_EVENTS) return "unknown";
+    return eventNames[event];
+}
+
+/* Zeroes all the counters. */
+void pcReset(PerfCounters *pCount) {
+    if (pCount == NULL) return;
+    for (int i = 0; i < PC_EVENTS; i++) {
+        pCount->values[i] = 0;
+        if (pCount->_fds[i] >= 0)
+            ioctl(pCount->_fds[i], PERF_EVENT_IOC_RESET, 0);
+    }
+}
+
+/* Starts, or resumes, counting. */
+void pcEnable(PerfCounters *pCount) {
+    if (pCount == NULL) return;
+    for (int i = 0; i < PC_EVENTS; i++)
+        if (pCount->_fds[i] >= 0)
+            ioctl(pCount->_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+}
+
+/* Pauses counting. */
+void pcDisable(PerfCounters *pCount) {
+    if (pCount == NULL) return;
+    for (int i = 0; i < PC_EVENTS; i++)
+        if (pCount->_fds[i] >= 0)
+            ioctl(pCount->_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+}
+
+/* Reads the counters into the values array, scaling them if the kernel had
+ * to multiplex them.
+ */
+void pcRead(PerfCounters *pCount) {
+    if (pCount == NULL) return;
+    for (int i = 0; i < PC_EVENTS; i++) {
+        pCount->values[i] = 0;
+        if (pCount->_fds[i] < 0) continue;
+        // Value, time enabled, time running.
+        uint64_t buf[3];
+        if (read(pCount->_fds[i], buf, sizeof(buf)) != sizeof(buf)) continue;
+        if ((buf[2] != 0) && (buf[2] < buf[1]))
+            buf[0] = (uint64_t)((double)buf[0] * (double)buf[1] /
+                                (double)buf[2]);
+        pCount->values[i] = buf[0];
+    }
+}
+
+/* Prints the last values read, divided by the number of operations, with
+ * "n/a" for the counters that are not available.
+ */
+void pcPrintPerOp(PerfCounters *pCount, ulong ops, FILE *out) {
+    if ((pCount == NULL) || (out == NULL) || (ops == 0)) return;
+    for (int i = 0; i < PC_EVENTS; i++) {
+        if (pCount->_fds[i] < 0) {
+            fprintf(out, " %s=n/a", eventNames[i]);
+            continue;
+        }
+        fprintf(out, " %s=%.3f", eventNames[i],
+                (double)pCount->values[i] / (double)ops);
+    }
+    fprintf(out, "\n");
+}
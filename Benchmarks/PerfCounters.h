@@ -0,0 +1,59 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for a small set of
+ * hardware performance counters, read through perf_event_open(2), used by the
+ * benchmark programs to explain their results.
+ * Each counter is opened on its own for the calling thread, counting user
+ * space only, so a counter that is not supported (or not allowed by
+ * perf_event_paranoid, or by a container) is simply marked as unavailable
+ * while the others keep working. If none can be opened, benchmarks still
+ * report their timings.
+ * Cache line transfers caused by other cores (HITM) have no generic event,
+ * so that counter is only opened if a raw, model-specific event code is
+ * given in the CB_PERF_HITM environment variable (e.g. "0x04d2" for
+ * MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM on many Intel cores).
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+/* Available counters. */
+typedef enum {
+    PC_CYCLES = 0,
+    PC_INSTRUCTIONS,
+    PC_L1D_MISSES,
+    PC_LLC_MISSES,
+    PC_BRANCH_MISSES,
+    PC_HITM,
+    PC_EVENTS       // Number of counters.
+} PCEvent;
+
+/* A counter set holds a file descriptor per counter (-1 if unavailable) and
+ * the values accumulated while counting was enabled, scaled to account for
+ * counter multiplexing.
+ */
+typedef struct {
+    int _fds[PC_EVENTS];
+    uint64_t values[PC_EVENTS];
+} PerfCounters;
+
+PerfCounters *createPerfCounters(void);
+void deletePerfCounters(PerfCounters *pCount);
+int pcAvailable(PerfCounters *pCount, PCEvent event);
+const char *pcName(PCEvent event);
+void pcReset(PerfCounters *pCount);
+void pcEnable(PerfCounters *pCount);
+void pcDisable(PerfCounters *pCount);
+void pcRead(PerfCounters *pCount);
+void pcPrintPerOp(PerfCounters *pCount, ulong ops, FILE *out);
+
+#endif
@@ -0,0 +1,183 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * Round-trip latency benchmark for producer-consumer handoff.
+ * Two threads, optionally pinned to given cores, bounce a token over a pair
+ * of rings: the "ping" thread writes into the first ring and waits for the
+ * "pong" thread to echo the token back through the second one. Each round
+ * trip is timed with the timestamp counter and recorded into a latency
+ * histogram, with coordinated omission correction when messages are paced.
+ * The p50, p99, p99.9 and max latencies are reported for each ring variant.
+ * Build with:
+ *     gcc -O2 -pthread -o PingPong PingPong.c BenchUtils.c LatencyHistogram.c
+ *         BenchRings.c ../FCBuffer/FCBuffer.c
+ *         ../SPSCBuffer/SPSCBuffer.c
+ *         ../CircularBuffer/CircularBuffer.c
+ * Usage:
+ *     ./PingPong [-p pingCore] [-q pongCore] [-n messages] [-w warmup]
+ *                [-i intervalNs] [-s ringSize] [-v variant]
+ * Placing the two cores on the same or on different sockets shows the cost
+ * of cross-socket cache line transfers; sockets are printed at startup.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "BenchRings.h"
+#include "BenchUtils.h"
+#include "LatencyHistogram.h"
+
+// Token that tells the pong thread to stop.
+#define STOP_TOKEN ((void *)UINTPTR_MAX)
+
+/* Benchmark configuration. */
+typedef struct {
+    int pingCore;
+    int pongCore;
+    ulong messages;
+    ulong warmup;
+    ulong intervalNs;
+    ulong ringSize;
+} PPConfig;
+
+/* State shared by the two threads. */
+typedef struct {
+    BenchRing *toPong;
+    BenchRing *toPing;
+    int core;
+} PPShared;
+
+/* Relaxes the CPU while spinning. */
+static inline void cpuRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/* Pong thread: echoes every token back until told to stop. */
+static void *pongThread(void *arg) {
+    PPShared *shared = arg;
+    if (!benchPinThread(shared->core))
+        fprintf(stderr, "Failed to pin pong thread to core %d\n",
+                shared->core);
+    for (;;) {
+        void *token;
+        while ((token = brRead(shared->toPong)) == NULL) cpuRelax();
+        if (token == STOP_TOKEN) break;
+        while (!brWrite(shared->toPing, token)) cpuRelax();
+    }
+    return NULL;
+}
+
+/* Runs the benchmark on a ring variant, recording into the histogram. */
+static int runVariant(BRVariant variant, PPConfig *cfg,
+                      LatencyHistogram *hist) {
+    PPShared shared;
+    shared.toPong = createBenchRing(variant, cfg->ringSize);
+    shared.toPing = createBenchRing(variant, cfg->ringSize);
+    shared.core = cfg->pongCore;
+    if ((shared.toPong == NULL) || (shared.toPing == NULL)) {
+        deleteBenchRing(shared.toPong);
+        deleteBenchRing(shared.toPing);
+        return 0;
+    }
+    pthread_t pong;
+    if (pthread_create(&pong, NULL, pongThread, &shared) != 0) {
+        deleteBenchRing(shared.toPong);
+        deleteBenchRing(shared.toPing);
+        return 0;
+    }
+    uint64_t intervalTicks = benchNsToTicks((double)cfg->intervalNs);
+    uint64_t start = benchTicks();
+    for (ulong i = 0; i < cfg->warmup + cfg->messages; i++) {
+        // When pacing, wait for the scheduled send time.
+        if (intervalTicks != 0)
+            while (benchTicks() < start + i * intervalTicks) cpuRelax();
+        void *token = (void *)(uintptr_t)(i + 1);
+        uint64_t t0 = benchTicks();
+        while (!brWrite(shared.toPong, token)) cpuRelax();
+        while (brRead(shared.toPing) == NULL) cpuRelax();
+        uint64_t t1 = benchTicks();
+        if (i >= cfg->warmup)
+            lhRecordCorrected(hist, (uint64_t)benchTicksToNs(t1 - t0),
+                              cfg->intervalNs);
+    }
+    while (!brWrite(shared.toPong, STOP_TOKEN)) cpuRelax();
+    pthread_join(pong, NULL);
+    deleteBenchRing(shared.toPong);
+    deleteBenchRing(shared.toPing);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    PPConfig cfg = {0, 1, 1000000, 10000, 0, 64};
+    int onlyVariant = -1;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:q:n:w:i:s:v:")) != -1) {
+        switch (opt) {
+            case 'p':
+                cfg.pingCore = atoi(optarg);
+                break;
+            case 'q':
+                cfg.pongCore = atoi(optarg);
+                break;
+            case 'n':
+                cfg.messages = strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                cfg.warmup = strtoul(optarg, NULL, 10);
+                break;
+            case 'i':
+                cfg.intervalNs = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                cfg.ringSize = strtoul(optarg, NULL, 10);
+                break;
+            case 'v':
+                onlyVariant = brVariantByName(optarg);
+                if (onlyVariant < 0) {
+                    fprintf(stderr, "Unknown variant: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-p pingCore] [-q pongCore] "
+                        "[-n messages] [-w warmup] [-i intervalNs] "
+                        "[-s ringSize] [-v variant]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    benchCalibrate();
+    if (!benchPinThread(cfg.pingCore))
+        fprintf(stderr, "Failed to pin ping thread to core %d\n",
+                cfg.pingCore);
+    int pingSocket = benchCoreSocket(cfg.pingCore);
+    int pongSocket = benchCoreSocket(cfg.pongCore);
+    printf("ping: core %d (socket %d), pong: core %d (socket %d), %s socket\n",
+           cfg.pingCore, pingSocket, cfg.pongCore, pongSocket,
+           pingSocket == pongSocket ? "same" : "cross");
+    printf("%lu messages, %lu warmup, interval %lu ns, ring size %lu\n",
+           cfg.messages, cfg.warmup, cfg.intervalNs, cfg.ringSize);
+    printf("Round-trip latencies (ns):\n");
+    LatencyHistogram *hist = createLHistogram();
+    if (hist == NULL) exit(EXIT_FAILURE);
+    for (int v = 0; v < BR_VARIANTS; v++) {
+        if ((onlyVariant >= 0) && (v != onlyVariant)) continue;
+        lhReset(hist);
+        if (!runVariant((BRVariant)v, &cfg, hist)) {
+            fprintf(stderr, "Failed to run variant %s\n", brName(v));
+            continue;
+        }
+        lhPrint(hist, brName(v), stdout);
+    }
+    deleteLHistogram(hist);
+    exit(EXIT_SUCCESS);
+}
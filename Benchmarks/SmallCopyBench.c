@@ -0,0 +1,116 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * Single-thread benchmark for cbCopy and cbPaste with small batches.
+ * For each batch size, a buffer is filled with pastes and drained with
+ * copies over and over, while the positions move all around it so that the
+ * wrap is crossed regularly. The cost per call is reported, together with
+ * that of a plain memcpy call of the same size for reference.
+ * Build with:
+ *     gcc -O2 -pthread -o SmallCopyBench SmallCopyBench.c BenchUtils.c
+ *         ../CircularBuffer/CircularBuffer.c
+ * Usage:
+ *     ./SmallCopyBench [-c core] [-s bufferSize] [-m maxBatch] [-n calls]
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../CircularBuffer/CircularBuffer.h"
+#include "BenchUtils.h"
+
+// Called through a pointer, so that the compiler can't inline it.
+static void *(*volatile memcpyPtr)(void *, const void *, size_t) = memcpy;
+
+int main(int argc, char **argv) {
+    int core = -1;
+    ulong size = 1021, maxBatch = 32, calls = 2000000;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:s:m:n:")) != -1) {
+        switch (opt) {
+            case 'c':
+                core = atoi(optarg);
+                break;
+            case 's':
+                size = strtoul(optarg, NULL, 10);
+                break;
+            case 'm':
+                maxBatch = strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                calls = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-c core] [-s bufferSize] "
+                        "[-m maxBatch] [-n calls]\n", argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if ((maxBatch == 0) || (2 * maxBatch > size) || (calls == 0)) {
+        fprintf(stderr, "Max batch must be between 1 and half the buffer "
+                "size\n");
+        exit(EXIT_FAILURE);
+    }
+    if (!benchPinThread(core))
+        fprintf(stderr, "Failed to pin to core %d\n", core);
+    benchCalibrate();
+    CircBuffer *cBuff = createCBuffer(size);
+    void **src = malloc(maxBatch * sizeof(void *));
+    void **dst = malloc(maxBatch * sizeof(void *));
+    if ((cBuff == NULL) || (src == NULL) || (dst == NULL)) {
+        fprintf(stderr, "Allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (ulong i = 0; i < maxBatch; i++) src[i] = (void *)(uintptr_t)(i + 1);
+    printf("buffer size %lu, %lu calls per batch size\n", size, calls);
+    printf("%6s %14s %14s %14s\n", "batch", "cbPaste ns", "cbCopy ns",
+           "memcpy ns");
+    for (ulong batch = 1; batch <= maxBatch; batch++) {
+        // Each round fills the buffer with pastes, then drains it with
+        // copies, leaving a few entries in to move the positions around.
+        ulong perRound = (size - batch) / batch;
+        ulong done = 0;
+        uint64_t pasteTicks = 0, copyTicks = 0;
+        while (done < calls) {
+            uint64_t start = benchTicks();
+            for (ulong i = 0; i < perRound; i++)
+                cbPaste(cBuff, src, batch, 0);
+            uint64_t mid = benchTicks();
+            for (ulong i = 0; i < perRound; i++)
+                cbCopy(cBuff, dst, batch, 0);
+            uint64_t end = benchTicks();
+            pasteTicks += mid - start;
+            copyTicks += end - mid;
+            done += perRound;
+            cbWrite(cBuff, src[0]);
+            if (cBuff->dataCount >= batch) cbCopy(cBuff, dst, batch, 0);
+        }
+        // Check that a batch goes through untouched, then reset.
+        while (cbCopy(cBuff, dst, size, 1) != 0);
+        cbPaste(cBuff, src, batch, 0);
+        cbCopy(cBuff, dst, batch, 0);
+        if (memcmp(src, dst, batch * sizeof(void *)) != 0) {
+            fprintf(stderr, "Data mismatch with batch size %lu\n", batch);
+            exit(EXIT_FAILURE);
+        }
+        uint64_t start = benchTicks();
+        for (ulong i = 0; i < calls; i++)
+            memcpyPtr(dst, src, batch * sizeof(void *));
+        uint64_t memcpyTicks = benchTicks() - start;
+        printf("%6lu %14.2f %14.2f %14.2f\n", batch,
+               benchTicksToNs(pasteTicks) / (double)done,
+               benchTicksToNs(copyTicks) / (double)done,
+               benchTicksToNs(memcpyTicks) / (double)calls);
+    }
+    deleteCBuffer(cBuff, 0);
+    free(src);
+    free(dst);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,245 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * Replays a Circular Buffer operation trace against the ring variants.
+ * Traces are recorded by building the library with CB_TRACE defined and
+ * calling cbTraceStart/cbTraceStop around the interesting part of a program
+ * (see CircularBufferTrace.h).
+ * Every thread found in the trace gets its own replay thread, which issues
+ * the same operations, with the same sizes, at the same times relative to
+ * the start of the replay (or back to back, with -f).
+ * For each variant, the latency of the replayed operations, how late they
+ * were issued with respect to the trace, and how many of them could not be
+ * completed are reported. Variants that only support one producer and one
+ * consumer are skipped unless the trace has a single thread, or at most one
+ * writing thread and one reading thread.
+ * Build with:
+ *     gcc -O2 -pthread -o TraceReplay TraceReplay.c BenchUtils.c
+ *         LatencyHistogram.c BenchRings.c ../FCBuffer/FCBuffer.c
+ *         ../SPSCBuffer/SPSCBuffer.c
+ *         ../CircularBuffer/CircularBuffer.c
+ *         ../CircularBuffer/CircularBufferTrace.c
+ * Usage:
+ *     ./TraceReplay [-f] [-s ringSize] [-v variant] traceFile
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../CircularBuffer/CircularBufferTrace.h"
+#include "BenchRings.h"
+#include "BenchUtils.h"
+#include "LatencyHistogram.h"
+
+/* State of a replay thread. */
+typedef struct {
+    BenchRing *ring;
+    CBTraceRecord *trace;
+    ulong traceCount;
+    uint16_t thread;            // Recorded thread to replay.
+    int fast;                   // Ignore timestamps.
+    uint64_t startTicks;
+    void **scratch;             // Data for copies and pastes.
+    ulong scratchSize;
+    LatencyHistogram *latency;
+    uint64_t maxLateNs;
+    ulong failed;
+    pthread_t tid;
+} ReplayThread;
+
+/* Relaxes the CPU while spinning. */
+static inline void cpuRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/* Replays the operations of one recorded thread. */
+static void *replayThread(void *arg) {
+    ReplayThread *rt = arg;
+    for (ulong i = 0; i < rt->traceCount; i++) {
+        CBTraceRecord *rec = rt->trace + i;
+        if (rec->thread != rt->thread) continue;
+        if (!rt->fast) {
+            // Wait until the operation is due.
+            uint64_t due = rt->startTicks + benchNsToTicks(
+                (double)rec->timestamp);
+            uint64_t now;
+            while ((now = benchTicks()) < due) cpuRelax();
+            uint64_t late = (uint64_t)benchTicksToNs(now - due);
+            if (late > rt->maxLateNs) rt->maxLateNs = late;
+        }
+        int upTo = rec->flags & CB_TRACE_UPTO;
+        ulong size = rec->size > rt->scratchSize ? rt->scratchSize :
+                     rec->size;
+        int done = 0;
+        uint64_t t0 = benchTicks();
+        switch (rec->op) {
+            case CB_OP_WRITE:
+                done = brWrite(rt->ring, rt->scratch[0]);
+                break;
+            case CB_OP_READ:
+                done = brRead(rt->ring) != NULL;
+                break;
+            case CB_OP_COPY:
+                done = brCopy(rt->ring, rt->scratch, size, upTo) != 0;
+                break;
+            case CB_OP_PASTE:
+                done = brPaste(rt->ring, rt->scratch, size, upTo) != 0;
+                break;
+            default:
+                break;
+        }
+        lhRecord(rt->latency, (uint64_t)benchTicksToNs(benchTicks() - t0));
+        if (!done) rt->failed++;
+        // Copies overwrite the scratch area: restore valid entries.
+        if (rec->op == CB_OP_COPY)
+            for (ulong j = 0; j < size; j++)
+                rt->scratch[j] = (void *)(uintptr_t)(j + 1);
+    }
+    return NULL;
+}
+
+/* Replays a trace against a variant and prints the results. */
+static void replay(BRVariant variant, ulong ringSize, int fast,
+                   CBTraceRecord *trace, ulong traceCount, uint16_t *threads,
+                   int nThreads, ulong maxSize) {
+    BenchRing *ring = createBenchRing(variant, ringSize);
+    ReplayThread *rts = calloc(nThreads, sizeof(ReplayThread));
+    LatencyHistogram *total = createLHistogram();
+    if ((ring == NULL) || (rts == NULL) || (total == NULL)) {
+        fprintf(stderr, "Allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    uint64_t startTicks = benchTicks() + benchNsToTicks(1000000.0);
+    for (int t = 0; t < nThreads; t++) {
+        ReplayThread *rt = rts + t;
+        rt->ring = ring;
+        rt->trace = trace;
+        rt->traceCount = traceCount;
+        rt->thread = threads[t];
+        rt->fast = fast;
+        rt->startTicks = startTicks;
+        rt->scratchSize = maxSize;
+        rt->scratch = malloc(maxSize * sizeof(void *));
+        rt->latency = createLHistogram();
+        if ((rt->scratch == NULL) || (rt->latency == NULL)) {
+            fprintf(stderr, "Allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        for (ulong j = 0; j < maxSize; j++)
+            rt->scratch[j] = (void *)(uintptr_t)(j + 1);
+    }
+    uint64_t wallStart = benchNowNs();
+    for (int t = 0; t < nThreads; t++)
+        pthread_create(&(rts[t].tid), NULL, replayThread, rts + t);
+    uint64_t maxLate = 0;
+    ulong failed = 0;
+    for (int t = 0; t < nThreads; t++) {
+        pthread_join(rts[t].tid, NULL);
+        lhMerge(total, rts[t].latency);
+        if (rts[t].maxLateNs > maxLate) maxLate = rts[t].maxLateNs;
+        failed += rts[t].failed;
+        deleteLHistogram(rts[t].latency);
+        free(rts[t].scratch);
+    }
+    double wallMs = (double)(benchNowNs() - wallStart) / 1e6;
+    printf("%s: %.3f ms, %lu ops not completed, max lateness %lu ns\n",
+           brName(variant), wallMs, failed, (unsigned long)maxLate);
+    lhPrint(total, "  op latency (ns)", stdout);
+    deleteLHistogram(total);
+    free(rts);
+    deleteBenchRing(ring);
+}
+
+int main(int argc, char **argv) {
+    ulong ringSize = 1024;
+    int fast = 0, onlyVariant = -1;
+    int opt;
+    while ((opt = getopt(argc, argv, "fs:v:")) != -1) {
+        switch (opt) {
+            case 'f':
+                fast = 1;
+                break;
+            case 's':
+                ringSize = strtoul(optarg, NULL, 10);
+                break;
+            case 'v':
+                onlyVariant = brVariantByName(optarg);
+                if (onlyVariant < 0) {
+                    fprintf(stderr, "Unknown variant: %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            default:
+                optind = argc;
+                break;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "Usage: %s [-f] [-s ringSize] [-v variant] "
+                "traceFile\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    ulong traceCount;
+    CBTraceRecord *trace = cbTraceLoad(argv[optind], &traceCount);
+    if (trace == NULL) {
+        fprintf(stderr, "Failed to load trace %s\n", argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+    // Find the recorded threads, which of them write and read, and the
+    // largest block transfer.
+    uint16_t threads[UINT16_MAX];
+    int writes[UINT16_MAX], reads[UINT16_MAX];
+    int nThreads = 0;
+    ulong maxSize = 1;
+    for (ulong i = 0; i < traceCount; i++) {
+        int t;
+        for (t = 0; t < nThreads; t++)
+            if (threads[t] == trace[i].thread) break;
+        if (t == nThreads) {
+            if (nThreads == UINT16_MAX) continue;
+            threads[nThreads] = trace[i].thread;
+            writes[nThreads] = reads[nThreads] = 0;
+            nThreads++;
+        }
+        if ((trace[i].op == CB_OP_WRITE) || (trace[i].op == CB_OP_PASTE))
+            writes[t] = 1;
+        else
+            reads[t] = 1;
+        if (trace[i].size > maxSize) maxSize = trace[i].size;
+    }
+    int writers = 0, readers = 0, mixed = 0;
+    for (int t = 0; t < nThreads; t++) {
+        writers += writes[t];
+        readers += reads[t];
+        mixed |= writes[t] && reads[t];
+    }
+    int spscOk = (nThreads == 1) ||
+                 ((writers <= 1) && (readers <= 1) && !mixed);
+    benchCalibrate();
+    printf("%lu operations from %d threads over %.3f ms, ring size %lu%s\n",
+           traceCount, nThreads,
+           (double)trace[traceCount - 1].timestamp / 1e6, ringSize,
+           fast ? ", back to back" : "");
+    for (int v = 0; v < BR_VARIANTS; v++) {
+        if ((onlyVariant >= 0) && (v != onlyVariant)) continue;
+        if (brIsSPSC(v) && !spscOk) {
+            printf("%s: skipped, the trace is not single producer and "
+                   "single consumer\n", brName(v));
+            continue;
+        }
+        replay((BRVariant)v, ringSize, fast, trace, traceCount, threads,
+               nThreads, maxSize);
+    }
+    free(trace);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,146 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage the Bipartite Buffer data
+ * structure.
+ * See the header file for a general description of the structure.
+ * See each function's comments for a description of their behaviour.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+
+#include "BipBuffer.h"
+
+/* Creates a new Bip Buffer of the specified size, in bytes. */
+BipBuffer *createBipBuffer(ulong bbSize) {
+    // Sanity check.
+    if (bbSize == 0) return NULL;
+    // Allocate memory for the new structure's metadata and data area.
+    BipBuffer *buffer = calloc(1, sizeof(BipBuffer));
+    if (buffer == NULL) return NULL;  // calloc failed.
+    buffer->_dataPtr = malloc(bbSize);
+    if (buffer->_dataPtr == NULL) {
+        // malloc failed.
+        free(buffer);
+        return NULL;
+    }
+    // Set up the new structure: everything else starts from zero.
+    buffer->bbSize = bbSize;
+    return buffer;
+}
+
+/* Deletes a Bip Buffer. */
+void deleteBipBuffer(BipBuffer *bBuff) {
+    if (bBuff == NULL) return;
+    free(bBuff->_dataPtr);
+    free(bBuff);
+}
+
+/* Reserves a contiguous area in the buffer, replacing any reservation still
+ * pending. The area is taken from the larger free one.
+ * Can be instructed to only reserve the whole size if "upTo=0", or up to the
+ * given size if "upTo=1"; the size actually reserved is stored in
+ * "reserved", if given.
+ * Returns a pointer to the start of the area, or NULL if there's no room.
+ */
+void *bipReserve(BipBuffer *bBuff, ulong size, int upTo, ulong *reserved) {
+    if (reserved != NULL) *reserved = 0;
+    // Sanity checks.
+    if ((bBuff == NULL) || (size == 0)) return NULL;
+    bBuff->_resSize = 0;
+    if (!bBuff->_bInUse && (bBuff->_aStart == bBuff->_aEnd)) {
+        // Empty buffer: start over from the beginning.
+        bBuff->_aStart = 0;
+        bBuff->_aEnd = 0;
+    }
+    ulong start, freeBytes;
+    int inB;
+    if (bBuff->_bInUse) {
+        // Region B grows towards region A.
+        start = bBuff->_bEnd;
+        freeBytes = bBuff->_aStart - bBuff->_bEnd;
+        inB = 1;
+    } else {
+        // Pick the larger of the areas after and before region A.
+        ulong after = bBuff->bbSize - bBuff->_aEnd;
+        ulong before = bBuff->_aStart;
+        if (after >= before) {
+            start = bBuff->_aEnd;
+            freeBytes = after;
+            inB = 0;
+        } else {
+            start = 0;
+            freeBytes = before;
+            inB = 1;
+        }
+    }
+    // Check operation requirements.
+    if (!freeBytes || (!upTo && (freeBytes < size))) return NULL;
+    bBuff->_resStart = start;
+    bBuff->_resSize = freeBytes >= size ? size : freeBytes;
+    bBuff->_resInB = inB;
+    if (reserved != NULL) *reserved = bBuff->_resSize;
+    return bBuff->_dataPtr + start;
+}
+
+/* Commits the first bytes of the pending reservation, making them available
+ * to readers, and drops the rest of it.
+ * Returns the number of bytes committed.
+ */
+ulong bipCommit(BipBuffer *bBuff, ulong size) {
+    if ((bBuff == NULL) || (bBuff->_resSize == 0)) return 0;  // Sanity check.
+    if (size > bBuff->_resSize) size = bBuff->_resSize;
+    if (bBuff->_resInB) {
+        bBuff->_bEnd += size;
+        if (size != 0) bBuff->_bInUse = 1;
+    } else {
+        bBuff->_aEnd += size;
+    }
+    bBuff->dataCount += size;
+    bBuff->_resSize = 0;
+    return size;
+}
+
+/* Gets the oldest committed data, as a contiguous block, without making it
+ * unavailable. Its size is stored in "size".
+ * Returns a pointer to the block, or NULL if there's no data.
+ */
+void *bipPeek(BipBuffer *bBuff, ulong *size) {
+    if (size != NULL) *size = 0;
+    if ((bBuff == NULL) || (bBuff->_aEnd == bBuff->_aStart)) return NULL;
+    if (size != NULL) *size = bBuff->_aEnd - bBuff->_aStart;
+    return bBuff->_dataPtr + bBuff->_aStart;
+}
+
+/* Releases the given number of bytes from the start of the oldest committed
+ * block, making them available for new reservations.
+ * Returns the number of bytes released.
+ */
+ulong bipRelease(BipBuffer *bBuff, ulong size) {
+    if (bBuff == NULL) return 0;  // Sanity check.
+    ulong inA = bBuff->_aEnd - bBuff->_aStart;
+    if (size > inA) size = inA;
+    bBuff->_aStart += size;
+    bBuff->dataCount -= size;
+    if (bBuff->_aStart == bBuff->_aEnd) {
+        if (bBuff->_bInUse) {
+            // Region A is drained: region B takes its place.
+            bBuff->_aStart = 0;
+            bBuff->_aEnd = bBuff->_bEnd;
+            bBuff->_bEnd = 0;
+            bBuff->_bInUse = 0;
+            bBuff->_resInB = 0;
+        } else if ((bBuff->_resSize == 0) || bBuff->_resInB) {
+            // Empty buffer: start over from the beginning, unless that would
+            // move a pending reservation after region A.
+            bBuff->_aStart = 0;
+            bBuff->_aEnd = 0;
+            bBuff->_resInB = 0;
+        }
+    }
+    return size;
+}
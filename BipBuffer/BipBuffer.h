@@ -0,0 +1,55 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the Bipartite
+ * Buffer (or "bip buffer") data structure. See the source file for a brief
+ * description of what each function does.
+ * A bip buffer is a circular buffer of bytes that never splits data across
+ * the wrap: it keeps up to two regions of committed data, "A" and, once the
+ * space after A runs out, "B", which always starts at the beginning of the
+ * data area and grows towards A. When A is drained, B takes its place.
+ * Writers reserve a contiguous area, fill it in place and then commit (part
+ * of) it; a reservation is taken from the larger of the two free areas, so
+ * that the largest possible contiguous block is always available.
+ * Readers get the oldest committed data as a single contiguous block, use
+ * it in place and then release (part of) it, in FIFO order.
+ * This makes it a near-zero-cost FIFO allocator for variable-size records,
+ * e.g. messages that are encoded and then transmitted.
+ * Only one reservation can be pending at a time.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef BIPBUFFER_H
+#define BIPBUFFER_H
+
+#include <sys/types.h>
+
+/* A bip buffer is made of a data area and its size, the bounds of region A,
+ * the end of region B (which always starts at 0) and whether it's in use,
+ * and the pending reservation, if any.
+ * A counter of the committed bytes is also made available.
+ */
+typedef struct {
+    char *_dataPtr;
+    ulong bbSize;
+    ulong _aStart;
+    ulong _aEnd;
+    ulong _bEnd;
+    int _bInUse;
+    int _resInB;
+    ulong _resStart;
+    ulong _resSize;
+    ulong dataCount;
+} BipBuffer;
+
+BipBuffer *createBipBuffer(ulong bbSize);
+void deleteBipBuffer(BipBuffer *bBuff);
+void *bipReserve(BipBuffer *bBuff, ulong size, int upTo, ulong *reserved);
+ulong bipCommit(BipBuffer *bBuff, ulong size);
+void *bipPeek(BipBuffer *bBuff, ulong *size);
+ulong bipRelease(BipBuffer *bBuff, ulong size);
+
+#endif
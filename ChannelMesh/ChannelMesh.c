@@ -0,0 +1,153 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage the Channel Mesh data structure.
+ * See the header file for a general description of the structure.
+ * See each function's comments for a description of their behaviour.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ChannelMesh.h"
+
+/* Returns the buffer from a producer to a consumer. */
+static inline SPSCBuffer *_cmRing(ChannelMesh *mesh, ulong producer,
+                                  ulong consumer) {
+    return mesh->_rings[(producer * mesh->nConsumers) + consumer];
+}
+
+/* Producer side: picks the consumer to send to, between the next two in
+ * turn, as the one whose buffer holds less entries.
+ */
+static inline ulong _cmPickTarget(ChannelMesh *mesh, ulong producer) {
+    ulong first = mesh->_prodCursors[producer]._cursor;
+    ulong second = first + 1 == mesh->nConsumers ? 0 : first + 1;
+    mesh->_prodCursors[producer]._cursor = second;
+    if (first == second) return first;
+    ulong firstLoad = spscCount(_cmRing(mesh, producer, first));
+    ulong secondLoad = spscCount(_cmRing(mesh, producer, second));
+    return secondLoad < firstLoad ? second : first;
+}
+
+/* Allocates an array of cursors, one per cache line. */
+static CMCursor *_cmNewCursors(ulong n) {
+    CMCursor *cursors = aligned_alloc(SPSC_CACHE_LINE, n * sizeof(CMCursor));
+    if (cursors != NULL) memset(cursors, 0, n * sizeof(CMCursor));
+    return cursors;
+}
+
+/* Creates a new Channel Mesh between the given numbers of producers and
+ * consumers, made of buffers of the given size (rounded up to a power of
+ * two), which don't grow.
+ */
+ChannelMesh *createChannelMesh(ulong nProducers, ulong nConsumers,
+                               ulong ringSize) {
+    // Sanity checks.
+    if ((nProducers == 0) || (nConsumers == 0) || (ringSize == 0) ||
+        (nProducers > ((ulong)-1 / sizeof(void *)) / nConsumers))
+        return NULL;
+    // Allocate memory for the new structure, its buffers and cursors.
+    ChannelMesh *mesh = calloc(1, sizeof(ChannelMesh));
+    if (mesh == NULL) return NULL;  // calloc failed.
+    mesh->nProducers = nProducers;
+    mesh->nConsumers = nConsumers;
+    mesh->_rings = calloc(nProducers * nConsumers, sizeof(SPSCBuffer *));
+    mesh->_prodCursors = _cmNewCursors(nProducers);
+    mesh->_consCursors = _cmNewCursors(nConsumers);
+    if ((mesh->_rings == NULL) || (mesh->_prodCursors == NULL) ||
+        (mesh->_consCursors == NULL)) {
+        deleteChannelMesh(mesh, 0);
+        return NULL;
+    }
+    for (ulong i = 0; i < nProducers * nConsumers; i++) {
+        mesh->_rings[i] = createSPSCBuffer(ringSize, ringSize);
+        if (mesh->_rings[i] == NULL) {
+            deleteChannelMesh(mesh, 0);
+            return NULL;
+        }
+    }
+    // Spread the producers' first choices.
+    for (ulong p = 0; p < nProducers; p++)
+        mesh->_prodCursors[p]._cursor = p % nConsumers;
+    return mesh;
+}
+
+/* Deletes a Channel Mesh. No thread may be using it. */
+void deleteChannelMesh(ChannelMesh *mesh, int toFree) {
+    if (mesh == NULL) return;
+    if (mesh->_rings != NULL)
+        for (ulong i = 0; i < mesh->nProducers * mesh->nConsumers; i++)
+            deleteSPSCBuffer(mesh->_rings[i], toFree);
+    free(mesh->_rings);
+    free(mesh->_prodCursors);
+    free(mesh->_consCursors);
+    free(mesh);
+}
+
+/* Sends an entry from the given producer to the least loaded of the next
+ * two consumers in turn, or to any other if that one is full.
+ * Returns 1 on success, 0 if all of its buffers were full.
+ */
+int cmWrite(ChannelMesh *mesh, ulong producer, void *data) {
+    return cmPaste(mesh, producer, &data, 1) == 1;
+}
+
+/* Sends a batch of entries from the given producer, in order, to the least
+ * loaded of the next two consumers in turn. If that one can't take them
+ * all, the rest go to the following consumers.
+ * Returns the number of entries sent.
+ */
+ulong cmPaste(ChannelMesh *mesh, ulong producer, void **dataBuf,
+              ulong bufSize) {
+    // Sanity checks.
+    if ((mesh == NULL) || (producer >= mesh->nProducers) ||
+        (dataBuf == NULL) || (bufSize == 0)) return 0;
+    ulong target = _cmPickTarget(mesh, producer);
+    ulong done = 0;
+    for (ulong i = 0; (i < mesh->nConsumers) && (done < bufSize); i++) {
+        done += spscPaste(_cmRing(mesh, producer, target), dataBuf + done,
+                          bufSize - done, 1);
+        target = target + 1 == mesh->nConsumers ? 0 : target + 1;
+    }
+    return done;
+}
+
+/* Receives an entry for the given consumer, from any producer.
+ * Returns the entry or NULL.
+ */
+void *cmRead(ChannelMesh *mesh, ulong consumer) {
+    void *data;
+    if (cmCopy(mesh, consumer, &data, 1) == 0) return NULL;
+    return data;
+}
+
+/* Receives entries for the given consumer, polling its inbound buffers in
+ * round-robin and taking up to CM_POLL_BATCH entries from each one per
+ * turn, until the array is full or there's nothing left.
+ * Returns the number of entries received.
+ */
+ulong cmCopy(ChannelMesh *mesh, ulong consumer, void **dataBuf,
+             ulong bufSize) {
+    // Sanity checks.
+    if ((mesh == NULL) || (consumer >= mesh->nConsumers) ||
+        (dataBuf == NULL) || (bufSize == 0)) return 0;
+    ulong producer = mesh->_consCursors[consumer]._cursor;
+    ulong done = 0, idle = 0;
+    while ((done < bufSize) && (idle < mesh->nProducers)) {
+        ulong want = bufSize - done;
+        if (want > CM_POLL_BATCH) want = CM_POLL_BATCH;
+        ulong got = spscCopy(_cmRing(mesh, producer, consumer),
+                             dataBuf + done, want, 1);
+        done += got;
+        idle = got == 0 ? idle + 1 : 0;
+        producer = producer + 1 == mesh->nProducers ? 0 : producer + 1;
+    }
+    // Start from the next producer next time.
+    mesh->_consCursors[consumer]._cursor = producer;
+    return done;
+}
@@ -0,0 +1,63 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the Channel
+ * Mesh, which connects many producer threads to many consumer threads.
+ * See the source file for a brief description of what each function does.
+ * Instead of a single queue shared by all threads, every producer gets a
+ * dedicated SPSC Buffer towards every consumer. Each buffer is only ever
+ * written by one thread and read by another, so no thread ever contends
+ * with more than one other thread on a cache line, and no atomic
+ * read-modify-write operation is needed at all.
+ * Producers choose where to send each entry (or batch) by load: they look
+ * at the next two consumers in turn and pick the one whose buffer is
+ * emptier, so that slow consumers get less work. Consumers poll their
+ * inbound buffers in round-robin, taking a bounded batch from each one, so
+ * that no producer is starved.
+ * Producers and consumers are identified by their index, and each index
+ * must be used by one thread only.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef CHANNELMESH_H
+#define CHANNELMESH_H
+
+#include <sys/types.h>
+
+#include "../SPSCBuffer/SPSCBuffer.h"
+
+// Maximum entries taken from each inbound buffer per polling turn.
+#define CM_POLL_BATCH 32
+
+/* The private state of a thread: where its round-robin cursor is. It sits
+ * on a cache line of its own.
+ */
+typedef struct {
+    ulong _cursor __attribute__((aligned(SPSC_CACHE_LINE)));
+} CMCursor;
+
+/* A channel mesh is made of a matrix of SPSC Buffers, one per producer and
+ * consumer pair (row by producer), and of the cursors of all threads.
+ */
+typedef struct {
+    SPSCBuffer **_rings;
+    ulong nProducers;
+    ulong nConsumers;
+    CMCursor *_prodCursors;
+    CMCursor *_consCursors;
+} ChannelMesh;
+
+ChannelMesh *createChannelMesh(ulong nProducers, ulong nConsumers,
+                               ulong ringSize);
+void deleteChannelMesh(ChannelMesh *mesh, int toFree);
+int cmWrite(ChannelMesh *mesh, ulong producer, void *data);
+ulong cmPaste(ChannelMesh *mesh, ulong producer, void **dataBuf,
+              ulong bufSize);
+void *cmRead(ChannelMesh *mesh, ulong consumer);
+ulong cmCopy(ChannelMesh *mesh, ulong consumer, void **dataBuf,
+             ulong bufSize);
+
+#endif
@@ -1,6 +1,6 @@
 /* Roberto Masocco
  * Creation Date: 28/7/2019
- * Latest Version: 30/7/2019
+ * Latest Version: 18/10/2026
  * ----------------------------------------------------------------------------
  * This file contains functions to manage the Circular Buffer data structure.
  * See the header file for a general description of the structure.
@@ -10,11 +10,262 @@
  * See the attached LICENSE file.
  */
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "CircularBuffer.h"
 
+// Operations are logged only if tracing is compiled in.
+#ifdef CB_TRACE
+#include "CircularBufferTrace.h"
+#define TRACE_OP(op, cBuff, size, upTo) cbTraceRecord(op, cBuff, size, upTo)
+#else
+#define TRACE_OP(op, cBuff, size, upTo)
+#endif
+
+/* Copies entries between arrays. Most transfers move just a few entries,
+ * for which a call to memcpy costs more than the copy itself: up to
+ * CB_SMALL_COPY entries are then moved inline, with two fixed-size moves
+ * that may overlap (e.g. 5 entries as 0-3 and 1-4), which the compiler
+ * turns into plain, possibly vector, loads and stores.
+ */
+#define CB_SMALL_COPY 16
+
+static inline void _cbMove(void **dst, void *const *src, ulong n) {
+    if (n > CB_SMALL_COPY) {
+        memcpy(dst, src, n * sizeof(void *));
+    } else if (n >= 8) {
+        __builtin_memcpy(dst, src, 8 * sizeof(void *));
+        __builtin_memcpy(dst + n - 8, src + n - 8, 8 * sizeof(void *));
+    } else if (n >= 4) {
+        __builtin_memcpy(dst, src, 4 * sizeof(void *));
+        __builtin_memcpy(dst + n - 4, src + n - 4, 4 * sizeof(void *));
+    } else if (n >= 2) {
+        __builtin_memcpy(dst, src, 2 * sizeof(void *));
+        __builtin_memcpy(dst + n - 2, src + n - 2, 2 * sizeof(void *));
+    } else if (n == 1) {
+        dst[0] = src[0];
+    }
+}
+
+/* Clears entries, in the same way as above. */
+static inline void _cbClear(void **dst, ulong n) {
+    if (n > CB_SMALL_COPY) {
+        memset(dst, 0, n * sizeof(void *));
+    } else if (n >= 8) {
+        __builtin_memset(dst, 0, 8 * sizeof(void *));
+        __builtin_memset(dst + n - 8, 0, 8 * sizeof(void *));
+    } else if (n >= 4) {
+        __builtin_memset(dst, 0, 4 * sizeof(void *));
+        __builtin_memset(dst + n - 4, 0, 4 * sizeof(void *));
+    } else if (n >= 2) {
+        __builtin_memset(dst, 0, 2 * sizeof(void *));
+        __builtin_memset(dst + n - 2, 0, 2 * sizeof(void *));
+    } else if (n == 1) {
+        dst[0] = NULL;
+    }
+}
+
+/* Count entries written and read, and update the high-water mark. The
+ * counters may be read by other threads at any time (e.g. by the metrics
+ * exporter), so they're stored atomically: relaxed stores are plain ones.
+ */
+static inline void _cbCountWrites(CircBuffer *cBuff, ulong n) {
+    __atomic_store_n(&(cBuff->writes), cBuff->writes + n, __ATOMIC_RELAXED);
+    if (cBuff->dataCount > cBuff->highWater)
+        __atomic_store_n(&(cBuff->highWater), cBuff->dataCount,
+                         __ATOMIC_RELAXED);
+}
+
+static inline void _cbCountReads(CircBuffer *cBuff, ulong n) {
+    __atomic_store_n(&(cBuff->reads), cBuff->reads + n, __ATOMIC_RELAXED);
+}
+
+/* Converts 32-bit slots back to pointers. Kept as a plain loop over arrays
+ * so that the compiler can vectorize it.
+ */
+static inline void _cbWiden(void **dst, const uint32_t *src, ulong n,
+                            char *base) {
+    for (ulong i = 0; i < n; i++)
+        dst[i] = base + src[i];
+}
+
+/* Converts pointers to 32-bit slots, vectorizable as above.
+ * Returns 1 if all the pointers were within 4 GB from the base, 0 otherwise.
+ */
+static inline int _cbNarrow(uint32_t *dst, void *const *src, ulong n,
+                            char *base) {
+    uintptr_t outOfRange = 0;
+    for (ulong i = 0; i < n; i++) {
+        uintptr_t offset = (uintptr_t)src[i] - (uintptr_t)base;
+        outOfRange |= offset >> 32;
+        dst[i] = (uint32_t)offset;
+    }
+    return outOfRange == 0;
+}
+
+/* Tells whether pointers are within 4 GB from the base of a compressed
+ * buffer, i.e. whether they can be stored in it, without storing them.
+ */
+static inline int _cbInRange(CircBuffer *cBuff, void *const *src, ulong n) {
+    uintptr_t outOfRange = 0;
+    for (ulong i = 0; i < n; i++)
+        outOfRange |= ((uintptr_t)src[i] - (uintptr_t)cBuff->_slotBase) >> 32;
+    return outOfRange == 0;
+}
+
+/* Reads an entry from a compressed buffer, which must not be empty. */
+static void *_cbRead32(CircBuffer *cBuff) {
+    void *newData = cBuff->_slotBase + *(cBuff->_readSlot);
+    cBuff->dataCount--;
+    _cbCountReads(cBuff, 1);
+    cBuff->_readSlot++;
+    if (cBuff->_readSlot == (cBuff->_dataSlots + cBuff->cbSize))
+        cBuff->_readSlot = cBuff->_dataSlots;
+    return newData;
+}
+
+/* Writes an entry in a compressed buffer, which must not be full.
+ * Returns 1 on success, 0 if the entry couldn't be compressed.
+ */
+static int _cbWrite32(CircBuffer *cBuff, void *data) {
+    if (!_cbNarrow(cBuff->_writeSlot, &data, 1, cBuff->_slotBase)) return 0;
+    cBuff->dataCount++;
+    _cbCountWrites(cBuff, 1);
+    cBuff->_writeSlot++;
+    if (cBuff->_writeSlot == (cBuff->_dataSlots + cBuff->cbSize))
+        cBuff->_writeSlot = cBuff->_dataSlots;
+    return 1;
+}
+
+/* Reads the given number of entries from a compressed buffer. */
+static ulong _cbCopy32(CircBuffer *cBuff, void **dataBuf, ulong ops) {
+    ulong toEnd = (ulong)((cBuff->_dataSlots + cBuff->cbSize) -
+                          cBuff->_readSlot);
+    if (toEnd < ops) {
+        // Two separate reads, wrapping around the buffer.
+        _cbWiden(dataBuf, cBuff->_readSlot, toEnd, cBuff->_slotBase);
+        _cbWiden(dataBuf + toEnd, cBuff->_dataSlots, ops - toEnd,
+                 cBuff->_slotBase);
+        cBuff->_readSlot = cBuff->_dataSlots + (ops - toEnd);
+    } else {
+        _cbWiden(dataBuf, cBuff->_readSlot, ops, cBuff->_slotBase);
+        cBuff->_readSlot += ops;
+        if (cBuff->_readSlot == (cBuff->_dataSlots + cBuff->cbSize))
+            cBuff->_readSlot = cBuff->_dataSlots;
+    }
+    cBuff->dataCount -= ops;
+    _cbCountReads(cBuff, ops);
+    return ops;
+}
+
+/* Writes the given number of entries in a compressed buffer.
+ * Nothing is written if any of them couldn't be compressed.
+ */
+static ulong _cbPaste32(CircBuffer *cBuff, void **dataBuf, ulong ops) {
+    ulong toEnd = (ulong)((cBuff->_dataSlots + cBuff->cbSize) -
+                          cBuff->_writeSlot);
+    // Free cells may be overwritten before finding a bad entry: it's fine.
+    if (toEnd < ops) {
+        // Two separate writes, wrapping around the buffer.
+        if (!_cbNarrow(cBuff->_writeSlot, dataBuf, toEnd,
+                       cBuff->_slotBase) ||
+            !_cbNarrow(cBuff->_dataSlots, dataBuf + toEnd, ops - toEnd,
+                       cBuff->_slotBase)) return 0;
+        cBuff->_writeSlot = cBuff->_dataSlots + (ops - toEnd);
+    } else {
+        if (!_cbNarrow(cBuff->_writeSlot, dataBuf, ops, cBuff->_slotBase))
+            return 0;
+        cBuff->_writeSlot += ops;
+        if (cBuff->_writeSlot == (cBuff->_dataSlots + cBuff->cbSize))
+            cBuff->_writeSlot = cBuff->_dataSlots;
+    }
+    cBuff->dataCount += ops;
+    _cbCountWrites(cBuff, ops);
+    return ops;
+}
+
+/* Counts rejected entries. Returns 0, i.e. no entries written. */
+static inline ulong _cbReject(CircBuffer *cBuff, ulong n) {
+    __atomic_store_n(&(cBuff->rejected), cBuff->rejected + n,
+                     __ATOMIC_RELAXED);
+    return 0;
+}
+
+/* Drops the given number of oldest entries, freeing them if the policy
+ * says so (entries of compressed buffers can't be freed on their own).
+ */
+static void _cbDrop(CircBuffer *cBuff, ulong n) {
+    cBuff->dataCount -= n;
+    __atomic_store_n(&(cBuff->dropped), cBuff->dropped + n, __ATOMIC_RELAXED);
+    if (cBuff->_flags & CB_COMPRESSED) {
+        ulong idx = (ulong)(cBuff->_readSlot - cBuff->_dataSlots) + n;
+        if (idx >= cBuff->cbSize) idx -= cBuff->cbSize;
+        cBuff->_readSlot = cBuff->_dataSlots + idx;
+        return;
+    }
+    for (ulong i = 0; i < n; i++) {
+        if (cBuff->_dropFree) free(*(cBuff->_readPtr));
+        *(cBuff->_readPtr) = NULL;
+        cBuff->_readPtr++;
+        if (cBuff->_readPtr == (cBuff->_dataPtr + cBuff->cbSize))
+            cBuff->_readPtr = cBuff->_dataPtr;
+    }
+}
+
+/* Drops new entries that were never stored, as if they had been stored and
+ * then dropped to make room for the ones that follow them.
+ */
+static void _cbDropNew(CircBuffer *cBuff, void **dataBuf, ulong n) {
+    _cbCountWrites(cBuff, n);
+    __atomic_store_n(&(cBuff->dropped), cBuff->dropped + n, __ATOMIC_RELAXED);
+    if (cBuff->_dropFree && !(cBuff->_flags & CB_COMPRESSED))
+        for (ulong i = 0; i < n; i++) free(dataBuf[i]);
+}
+
+/* Applies the admission policy to a batch of new entries, no more than the
+ * buffer's size, which may be written only in part if "upTo" is set. If the
+ * policy makes room for them by dropping old ones, stores how many in
+ * "toDrop": they're dropped by the caller, only once the entries are known
+ * to be storable.
+ * Returns 1 if they may be written, 0 if they must be rejected.
+ */
+static int _cbAdmit(CircBuffer *cBuff, ulong n, int upTo, ulong *toDrop) {
+    ulong freeCells = cBuff->cbSize - cBuff->dataCount;
+    ulong minFill = cBuff->_policyParam;
+    uint64_t x = cBuff->_rngState;
+    switch (cBuff->_policy) {
+        case CB_POLICY_DROP_OLDEST:
+            if (freeCells < n) *toDrop = n - freeCells;
+            return 1;
+        case CB_POLICY_EARLY_DROP:
+            // Reject with a probability that grows linearly from 0, at the
+            // given fill level, to 1 when full (xorshift64 generator).
+            if (cBuff->dataCount <= minFill) return 1;
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            cBuff->_rngState = x;
+            return (x % (cBuff->cbSize - minFill)) >=
+                   (cBuff->dataCount - minFill);
+        case CB_POLICY_SAMPLE:
+            // Only entries that don't fit are sampled: if they may be
+            // written in part, the ones that fit are admitted anyway.
+            if (freeCells >= n) return 1;
+            if (++cBuff->_sampleCount < cBuff->_policyParam)
+                return upTo && (freeCells != 0);
+            cBuff->_sampleCount = 0;
+            *toDrop = n - freeCells;
+            return 1;
+        default:
+            return 1;
+    }
+}
+
 /* Creates a new Circular Buffer of the specified size. */
 CircBuffer *createCBuffer(ulong cbSize) {
     // Sanity check.
@@ -37,14 +288,137 @@ CircBuffer *createCBuffer(ulong cbSize) {
     return buffer;
 }
 
+/* Creates a new compressed Circular Buffer of the specified size, whose
+ * entries must all point within 4 GB from the given base address.
+ */
+CircBuffer *createCBufferCompressed(ulong cbSize, void *base) {
+    // Sanity checks.
+    if ((cbSize == 0) || (base == NULL)) return NULL;
+    // Allocate memory for the new structure's metadata and data area.
+    CircBuffer *buffer = calloc(1, sizeof(CircBuffer));
+    if (buffer == NULL) return NULL;  // calloc failed.
+    uint32_t *dataArea = calloc(cbSize, sizeof(uint32_t));
+    if (dataArea == NULL) {
+        // calloc failed.
+        free(buffer);
+        return NULL;
+    }
+    // Set up the new structure.
+    buffer->cbSize = cbSize;
+    buffer->_dataSlots = dataArea;
+    buffer->_readSlot = dataArea;
+    buffer->_writeSlot = dataArea;
+    buffer->dataCount = 0;
+    buffer->_flags = CB_COMPRESSED;
+    buffer->_slotBase = base;
+    return buffer;
+}
+
+/* Creates a new Circular Buffer of the specified size, whose memory comes
+ * from the given allocator, which must outlive it.
+ * The data area is zeroed only if "zeroFill" is set: the buffer itself never
+ * reads the cells it hasn't written, so large buffers that are about to be
+ * filled can skip that cost.
+ */
+CircBuffer *createCBufferAlloc(ulong cbSize, const CBAllocator *alloc,
+                               int zeroFill) {
+    // Sanity checks.
+    if ((cbSize == 0) || (cbSize > (ULONG_MAX / sizeof(void *))) ||
+        (alloc == NULL) || (alloc->alloc == NULL) || (alloc->free == NULL))
+        return NULL;
+    // Allocate memory for the new structure's metadata and data area.
+    CircBuffer *buffer = alloc->alloc(alloc->ctx, sizeof(CircBuffer),
+                                      _Alignof(CircBuffer));
+    if (buffer == NULL) return NULL;  // alloc failed.
+    void **dataArea = alloc->alloc(alloc->ctx, cbSize * sizeof(void *),
+                                   _Alignof(void *));
+    if (dataArea == NULL) {
+        // alloc failed.
+        alloc->free(alloc->ctx, buffer, sizeof(CircBuffer));
+        return NULL;
+    }
+    if (zeroFill) memset(dataArea, 0, cbSize * sizeof(void *));
+    // Set up the new structure.
+    memset(buffer, 0, sizeof(CircBuffer));
+    buffer->cbSize = cbSize;
+    buffer->_dataPtr = dataArea;
+    buffer->_readPtr = dataArea;
+    buffer->_writePtr = dataArea;
+    buffer->dataCount = 0;
+    buffer->_flags = CB_ALLOCATED;
+    buffer->_alloc = alloc;
+    return buffer;
+}
+
+/* Reads the monotonic clock, in nanoseconds. */
+static inline uint64_t _cbNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Creates a new Circular Buffer of the specified size, with its data area
+ * mapped from the OS instead of allocated in the heap.
+ * Pages that hold no data can then be released with cbTrim, or with
+ * cbTrimIdle once the buffer has been idle for "idleMs" milliseconds
+ * (0 disables idle trimming).
+ * If "lazyFree" is set, pages are released with MADV_FREE, which is cheaper
+ * but lets the OS take them back only when memory is needed.
+ */
+CircBuffer *createCBufferMapped(ulong cbSize, ulong idleMs, int lazyFree) {
+    // Sanity checks.
+    if ((cbSize == 0) || (cbSize > (ULONG_MAX / sizeof(void *)))) return NULL;
+    // Allocate memory for the new structure's metadata, and map the data
+    // area, rounding it up to a whole number of pages.
+    CircBuffer *buffer = calloc(1, sizeof(CircBuffer));
+    if (buffer == NULL) return NULL;  // calloc failed.
+    ulong pageSize = (ulong)sysconf(_SC_PAGESIZE);
+    ulong mapSize = ((cbSize * sizeof(void *)) + pageSize - 1) &
+                    ~(pageSize - 1);
+    void **dataArea = mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (dataArea == MAP_FAILED) {
+        // mmap failed.
+        free(buffer);
+        return NULL;
+    }
+    // Set up the new structure.
+    buffer->cbSize = cbSize;
+    buffer->_dataPtr = dataArea;
+    buffer->_readPtr = dataArea;
+    buffer->_writePtr = dataArea;
+    buffer->dataCount = 0;
+    buffer->_flags = CB_MAPPED | (lazyFree ? CB_LAZY_FREE : 0);
+    buffer->_mapSize = mapSize;
+    buffer->_idleNs = (uint64_t)idleMs * 1000000ULL;
+    buffer->_lastActiveNs = _cbNowNs();
+    return buffer;
+}
+
 /* Deletes a Circular Buffer. */
 void deleteCBuffer(CircBuffer *cBuff, int toFree) {
     if (cBuff == NULL) return;
-    if (toFree)
-        // If requested, free all the entries before destroying the structure.
-        for (ulong i = 0; i < cBuff->cbSize; i++)
-            free((cBuff->_dataPtr)[i]);
-    free(cBuff->_dataPtr);
+    // Entries of compressed buffers point inside a single area, so they
+    // can't be freed on their own.
+    if (toFree && !(cBuff->_flags & CB_COMPRESSED)) {
+        // If requested, free all the entries held before destroying the
+        // structure (free cells may hold anything, if they weren't zeroed).
+        void **entry = cBuff->_readPtr;
+        for (ulong i = 0; i < cBuff->dataCount; i++) {
+            free(*entry);
+            if (++entry == (cBuff->_dataPtr + cBuff->cbSize))
+                entry = cBuff->_dataPtr;
+        }
+    }
+    if (cBuff->_flags & CB_ALLOCATED) {
+        const CBAllocator *alloc = cBuff->_alloc;
+        alloc->free(alloc->ctx, cBuff->_dataPtr,
+                    cBuff->cbSize * sizeof(void *));
+        alloc->free(alloc->ctx, cBuff, sizeof(CircBuffer));
+        return;
+    }
+    if (cBuff->_flags & CB_MAPPED) munmap(cBuff->_dataPtr, cBuff->_mapSize);
+    else free(cBuff->_dataPtr);
     free(cBuff);
 }
 
@@ -52,12 +426,15 @@ void deleteCBuffer(CircBuffer *cBuff, int toFree) {
  * Returns the entry or NULL.
  */
 void *cbRead(CircBuffer *cBuff) {
+    TRACE_OP(CB_OP_READ, cBuff, 1, 0);
     if (cBuff == NULL) return NULL;  // Sanity check.
     if (cBuff->dataCount == 0) return NULL;  // Empty buffer.
+    if (cBuff->_flags & CB_COMPRESSED) return _cbRead32(cBuff);
     // Now, the read pointer points to the next available data.
     void *newData = *(cBuff->_readPtr);
     *(cBuff->_readPtr) = NULL;
     cBuff->dataCount--;
+    _cbCountReads(cBuff, 1);
     // Now, advance and eventually wrap around the pointer.
     cBuff->_readPtr++;
     if (cBuff->_readPtr == (cBuff->_dataPtr + cBuff->cbSize))
@@ -69,11 +446,28 @@ void *cbRead(CircBuffer *cBuff) {
  * Returns 1 on success, 0 if the buffer was full.
  */
 int cbWrite(CircBuffer *cBuff, void *data) {
+    TRACE_OP(CB_OP_WRITE, cBuff, 1, 0);
     if ((cBuff == NULL) || (data == NULL)) return 0;  // Sanity check.
-    if (cBuff->dataCount == cBuff->cbSize) return 0;  // Full buffer.
+    // Apply the admission policy, if any.
+    ulong toDrop = 0;
+    if ((cBuff->_policy != CB_POLICY_REJECT) &&
+        !_cbAdmit(cBuff, 1, 0, &toDrop)) return (int)_cbReject(cBuff, 1);
+    if ((cBuff->dataCount - toDrop) == cBuff->cbSize)
+        return (int)_cbReject(cBuff, 1);  // Full buffer.
+    if (toDrop != 0) {
+        // Don't drop anything for an entry that can't be stored.
+        if ((cBuff->_flags & CB_COMPRESSED) && !_cbInRange(cBuff, &data, 1))
+            return (int)_cbReject(cBuff, 1);
+        _cbDrop(cBuff, toDrop);
+    }
+    if (cBuff->_flags & CB_COMPRESSED) {
+        if (!_cbWrite32(cBuff, data)) return (int)_cbReject(cBuff, 1);
+        return 1;
+    }
     // Now, the write pointer points to the next available location.
     *(cBuff->_writePtr) = data;
     cBuff->dataCount++;
+    _cbCountWrites(cBuff, 1);
     // Now, advance and eventually wrap around the pointer.
     cBuff->_writePtr++;
     if (cBuff->_writePtr == (cBuff->_dataPtr + cBuff->cbSize))
@@ -87,6 +481,7 @@ int cbWrite(CircBuffer *cBuff, void *data) {
  * Returns the number of read operations performed.
  */
 ulong cbCopy(CircBuffer *cBuff, void **dataBuf, ulong bufSize, int upTo) {
+    TRACE_OP(CB_OP_COPY, cBuff, bufSize, upTo);
     // Sanity checks.
     if ((dataBuf == NULL) || (bufSize == 0) || (cBuff == NULL)) return 0;
     if (!upTo && (bufSize > cBuff->cbSize)) return 0;
@@ -96,63 +491,230 @@ ulong cbCopy(CircBuffer *cBuff, void **dataBuf, ulong bufSize, int upTo) {
     ulong ops;
     if (!upTo) ops = bufSize;
     else ops = cBuff->dataCount >= bufSize ? bufSize : cBuff->dataCount;
+    if (cBuff->_flags & CB_COMPRESSED) return _cbCopy32(cBuff, dataBuf, ops);
     // Read data from the buffer.
-    if (((cBuff->_dataPtr + cBuff->cbSize) - cBuff->_readPtr) < ops) {
+    ulong toEnd = (cBuff->_dataPtr + cBuff->cbSize) - cBuff->_readPtr;
+    if (toEnd < ops) {
         // Two separate reads must be done to correctly wrap the pointer
         // around the buffer.
-        ulong toEnd = (cBuff->_dataPtr + cBuff->cbSize) - cBuff->_readPtr;
-        memcpy(dataBuf, cBuff->_readPtr, toEnd * sizeof(void *));
-        memset(cBuff->_readPtr, 0, toEnd * sizeof(void *));
+        _cbMove(dataBuf, cBuff->_readPtr, toEnd);
+        _cbClear(cBuff->_readPtr, toEnd);
         cBuff->_readPtr = cBuff->_dataPtr;
-        memcpy(dataBuf + toEnd, cBuff->_readPtr,
-                (ops - toEnd) * sizeof(void *));
-        memset(cBuff->_readPtr, 0, (ops - toEnd) * sizeof(void *));
+        _cbMove(dataBuf + toEnd, cBuff->_readPtr, ops - toEnd);
+        _cbClear(cBuff->_readPtr, ops - toEnd);
         cBuff->_readPtr += (ops - toEnd);
     } else {
         // All reads can be done in one go.
-        memcpy(dataBuf, cBuff->_readPtr, ops * sizeof(void *));
-        memset(cBuff->_readPtr, 0, ops * sizeof(void *));
+        _cbMove(dataBuf, cBuff->_readPtr, ops);
+        _cbClear(cBuff->_readPtr, ops);
         cBuff->_readPtr += ops;
-        if (cBuff->_readPtr == (cBuff->_dataPtr + cBuff->cbSize))
-            cBuff->_readPtr = cBuff->_dataPtr;
+        if (toEnd == ops) cBuff->_readPtr = cBuff->_dataPtr;
     }
     cBuff->dataCount -= ops;
+    _cbCountReads(cBuff, ops);
     return ops;
 }
 
 /* Writes a block of data into the buffer.
  * Can be instructed to only write to the buffer if there's enough room for
  * all the data or up to the given amount if "upTo=1".
+ * If the buffer drops its oldest entries and the block is larger than the
+ * buffer, only its newest entries are stored: the leading ones, which they
+ * would drop anyway, are counted as written and dropped right away.
  * Returns the number of write operations performed.
  */
 ulong cbPaste(CircBuffer *cBuff, void **dataBuf, ulong bufSize, int upTo) {
+    TRACE_OP(CB_OP_PASTE, cBuff, bufSize, upTo);
     // Sanity checks.
     if ((dataBuf == NULL) || (bufSize == 0) || (cBuff == NULL)) return 0;
-    if (!upTo && (bufSize > cBuff->cbSize)) return 0;
-    ulong freeCells = cBuff->cbSize - cBuff->dataCount;
+    if (!upTo && (bufSize > cBuff->cbSize))
+        return _cbReject(cBuff, bufSize);
+    // Entries that the newest ones would drop at once are skipped.
+    ulong skip = 0;
+    if (upTo && (cBuff->_policy == CB_POLICY_DROP_OLDEST) &&
+        (bufSize > cBuff->cbSize)) skip = bufSize - cBuff->cbSize;
+    void **src = dataBuf + skip;
+    // Apply the admission policy, if any, to as many entries as may fit.
+    ulong toDrop = 0;
+    if ((cBuff->_policy != CB_POLICY_REJECT) &&
+        !_cbAdmit(cBuff, bufSize < cBuff->cbSize ? bufSize : cBuff->cbSize,
+                  upTo, &toDrop))
+        return _cbReject(cBuff, bufSize);
+    ulong freeCells = cBuff->cbSize - cBuff->dataCount + toDrop;
     // Check operation requirements.
-    if (!freeCells || (!upTo && (freeCells < bufSize))) return 0;
+    if (!freeCells || (!upTo && (freeCells < bufSize)))
+        return _cbReject(cBuff, bufSize);
     // Set the number of operations to do.
     ulong ops;
     if (!upTo) ops = bufSize;
     else ops = freeCells >= bufSize ? bufSize : freeCells;
+    if (toDrop != 0) {
+        // Don't drop anything for entries that can't be stored.
+        if ((cBuff->_flags & CB_COMPRESSED) && !_cbInRange(cBuff, src, ops))
+            return _cbReject(cBuff, bufSize);
+        _cbDrop(cBuff, toDrop);
+    }
+    if (cBuff->_flags & CB_COMPRESSED) {
+        if (_cbPaste32(cBuff, src, ops) == 0)
+            return _cbReject(cBuff, bufSize);
+        if (skip != 0) _cbDropNew(cBuff, dataBuf, skip);
+        if ((skip + ops) < bufSize) _cbReject(cBuff, bufSize - (skip + ops));
+        return skip + ops;
+    }
     // Write data to the buffer.
-    if (((cBuff->_dataPtr + cBuff->cbSize) - cBuff->_writePtr) < ops) {
+    ulong toEnd = (cBuff->_dataPtr + cBuff->cbSize) - cBuff->_writePtr;
+    if (toEnd < ops) {
         // Two separate writes must be done to correctly wrap the pointer
         // around the buffer.
-        ulong toEnd = (cBuff->_dataPtr + cBuff->cbSize) - cBuff->_writePtr;
-        memcpy(cBuff->_writePtr, dataBuf, toEnd * sizeof(void *));
+        _cbMove(cBuff->_writePtr, src, toEnd);
         cBuff->_writePtr = cBuff->_dataPtr;
-        memcpy(cBuff->_writePtr, dataBuf + toEnd,
-               (ops - toEnd) * sizeof(void *));
+        _cbMove(cBuff->_writePtr, src + toEnd, ops - toEnd);
         cBuff->_writePtr += (ops - toEnd);
     } else {
         // All writes can be done in one go.
-        memcpy(cBuff->_writePtr, dataBuf, ops * sizeof(void *));
+        _cbMove(cBuff->_writePtr, src, ops);
         cBuff->_writePtr += ops;
-        if (cBuff->_writePtr == (cBuff->_dataPtr + cBuff->cbSize))
-            cBuff->_writePtr = cBuff->_dataPtr;
+        if (toEnd == ops) cBuff->_writePtr = cBuff->_dataPtr;
     }
     cBuff->dataCount += ops;
-    return ops;
+    _cbCountWrites(cBuff, ops);
+    if (skip != 0) _cbDropNew(cBuff, dataBuf, skip);
+    if ((skip + ops) < bufSize) _cbReject(cBuff, bufSize - (skip + ops));
+    return skip + ops;
+}
+
+/* Releases the whole pages in a portion of a mapped data area.
+ * Returns the number of bytes released.
+ */
+static ulong _cbRelease(CircBuffer *cBuff, void **from, void **to) {
+    uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = ((uintptr_t)from + pageSize - 1) & ~(pageSize - 1);
+    uintptr_t end = (uintptr_t)to & ~(pageSize - 1);
+    if (end <= start) return 0;
+    int advice = MADV_DONTNEED;
+#ifdef MADV_FREE
+    if (cBuff->_flags & CB_LAZY_FREE) advice = MADV_FREE;
+#endif
+    if (madvise((void *)start, end - start, advice) != 0) return 0;
+    return end - start;
+}
+
+/* Gives back to the OS the pages of a mapped buffer that hold no data.
+ * Since free cells are always zeroed, they read the same if their pages are
+ * mapped back in, which happens on their own as soon as data reaches them.
+ * Returns the number of bytes released (0 for buffers not mapped).
+ */
+ulong cbTrim(CircBuffer *cBuff) {
+    // Sanity checks.
+    if ((cBuff == NULL) || !(cBuff->_flags & CB_MAPPED)) return 0;
+    if (cBuff->dataCount == cBuff->cbSize) return 0;  // Full buffer.
+    void **mapEnd = (void **)((char *)cBuff->_dataPtr + cBuff->_mapSize);
+    ulong released;
+    if (cBuff->dataCount == 0) {
+        // Empty buffer: everything can go.
+        released = _cbRelease(cBuff, cBuff->_dataPtr, mapEnd);
+    } else if (cBuff->_writePtr < cBuff->_readPtr) {
+        // Free cells lie between the two pointers.
+        released = _cbRelease(cBuff, cBuff->_writePtr, cBuff->_readPtr);
+    } else {
+        // Free cells wrap around the end of the data area.
+        released = _cbRelease(cBuff, cBuff->_writePtr, mapEnd);
+        released += _cbRelease(cBuff, cBuff->_dataPtr, cBuff->_readPtr);
+    }
+    cBuff->_flags |= CB_TRIMMED;
+    return released;
+}
+
+/* Trims a mapped buffer if it's been idle for longer than its idle period.
+ * Meant to be called periodically (e.g. from a timer): a buffer is
+ * considered idle if nothing was written or read since the previous call
+ * (its pointers could have come full circle), and it's trimmed only once
+ * per idle period.
+ * Returns the number of bytes released.
+ */
+ulong cbTrimIdle(CircBuffer *cBuff) {
+    // Sanity checks.
+    if ((cBuff == NULL) || !(cBuff->_flags & CB_MAPPED)) return 0;
+    if (cBuff->_idleNs == 0) return 0;
+    uint64_t now = _cbNowNs();
+    // Pointers may be back where they were after a full lap, so activity is
+    // told from the writes and reads counters kept by the data routines.
+    if ((cBuff->writes != cBuff->_lastWrites) ||
+        (cBuff->reads != cBuff->_lastReads)) {
+        // The buffer has been used since the last check.
+        cBuff->_lastWrites = cBuff->writes;
+        cBuff->_lastReads = cBuff->reads;
+        cBuff->_lastActiveNs = now;
+        cBuff->_flags &= ~CB_TRIMMED;
+        return 0;
+    }
+    if ((cBuff->_flags & CB_TRIMMED) ||
+        ((now - cBuff->_lastActiveNs) < cBuff->_idleNs)) return 0;
+    return cbTrim(cBuff);
+}
+
+/* Reports how many bytes a buffer's data area reserves, and how many of
+ * them are actually resident in memory.
+ * Data areas allocated in the heap are always reported as fully resident.
+ */
+void cbMemoryUsage(CircBuffer *cBuff, ulong *reserved, ulong *resident) {
+    ulong res = 0, resv = 0;
+    if (cBuff != NULL) {
+        if (cBuff->_flags & CB_MAPPED) {
+            resv = cBuff->_mapSize;
+            // Ask the OS which pages are in memory.
+            ulong pageSize = (ulong)sysconf(_SC_PAGESIZE);
+            ulong pages = resv / pageSize;
+            unsigned char *vec = malloc(pages);
+            if ((vec != NULL) &&
+                (mincore(cBuff->_dataPtr, resv, vec) == 0)) {
+                for (ulong i = 0; i < pages; i++)
+                    if (vec[i] & 1) res += pageSize;
+            } else {
+                res = resv;  // Can't tell.
+            }
+            free(vec);
+        } else {
+            resv = cBuff->cbSize * ((cBuff->_flags & CB_COMPRESSED) ?
+                                    sizeof(uint32_t) : sizeof(void *));
+            res = resv;
+        }
+    }
+    if (reserved != NULL) *reserved = resv;
+    if (resident != NULL) *resident = res;
+}
+
+/* Sets the admission policy of the given buffer, which applies to the
+ * writes that follow:
+ * - CB_POLICY_REJECT: new entries are rejected if the buffer is full.
+ * - CB_POLICY_DROP_OLDEST: the oldest entries are dropped to make room.
+ * - CB_POLICY_EARLY_DROP: new entries are also rejected at random once the
+ *   buffer holds more than "param" entries, with a probability that grows
+ *   linearly up to 1 when it's full.
+ * - CB_POLICY_SAMPLE: of the writes that don't fit, only one in "param" is
+ *   admitted, dropping the oldest entries to make room for it; pastes that
+ *   may be partial still store the entries that fit.
+ * Each paste counts as a single write, of as many entries as may fit.
+ * Dropped entries are also freed if "toFree" is set.
+ * Policies that drop entries can't be set on the primary buffer of a
+ * replication (see CircularBufferRepl.h), which must keep them until they
+ * are acknowledged.
+ * Returns 1 on success, 0 if the arguments are invalid.
+ */
+int cbSetPolicy(CircBuffer *cBuff, int policy, ulong param, int toFree) {
+    // Sanity checks.
+    if ((cBuff == NULL) || (policy < CB_POLICY_REJECT) ||
+        (policy > CB_POLICY_SAMPLE) ||
+        ((policy == CB_POLICY_EARLY_DROP) && (param >= cBuff->cbSize)) ||
+        ((policy == CB_POLICY_SAMPLE) && (param == 0))) return 0;
+    if ((cBuff->_flags & CB_REPLICATED) &&
+        ((policy == CB_POLICY_DROP_OLDEST) || (policy == CB_POLICY_SAMPLE)))
+        return 0;
+    cBuff->_policy = policy;
+    cBuff->_policyParam = param;
+    cBuff->_dropFree = toFree;
+    cBuff->_sampleCount = 0;
+    // Seed the random generator, which must not be zero.
+    cBuff->_rngState = ((uint64_t)(uintptr_t)cBuff ^ _cbNowNs()) | 1;
+    return 1;
 }
@@ -1,6 +1,6 @@
 /* Roberto Masocco
  * Creation Date: 28/7/2019
- * Latest Version: 30/7/2019
+ * Latest Version: 18/10/2026
  * ----------------------------------------------------------------------------
  * This file contains type definitions and declarations for the Circular Buffer
  * data structure. See the source file for a brief description of what each
@@ -21,6 +21,20 @@
  * This library uses dynamic memory allocation in the heap, since the whole
  * structure with its metadata is created there when requested, and freed as
  * such. Options are provided to free elements too upon structure deletion.
+ * Buffers can also have their data area mapped directly from the OS: pages
+ * that hold no data can then be given back, either explicitly or after the
+ * buffer stays idle for a while, and are mapped again when data reaches them.
+ * Memory can also come from an allocator supplied by the user (e.g. an arena
+ * per NUMA node), optionally without zeroing the data area.
+ * What happens to writes when a buffer is full can be chosen per buffer with
+ * an admission policy, applied by cbWrite and cbPaste: reject the newest
+ * entries (the default), drop the oldest ones, drop early with a probability
+ * that grows with the occupancy, or admit one in N; counters keep track of
+ * what was rejected and dropped.
+ * Buffers also count the entries written and read, and remember the most
+ * entries they ever held; see CircularBufferMetrics.h to export these.
+ * If compiled with CB_TRACE defined, the library can record every data
+ * operation in a binary trace; see CircularBufferTrace.h.
  */
 /* This code is released under the MIT license.
  * See the attached LICENSE file.
@@ -37,28 +51,101 @@
  * the single bytes prior to writing and after reading is suggested.
  * If you'd like to account for the eventual overhead caused by unused bytes
  * in each "void *", you'll have to modify the library to suit your needs.
+ * If all the entries point inside a single memory area smaller than 4 GB,
+ * a compressed buffer can be used instead: it stores 32-bit offsets from the
+ * start of that area, halving its size, and converts them back and forth on
+ * the fly, so the same routines keep taking and returning pointers.
  */
 
+#include <stddef.h>
+#include <stdint.h>
 #include <sys/types.h>
 
+// Buffer flags.
+#define CB_MAPPED 0x1       // Data area mapped with mmap.
+#define CB_LAZY_FREE 0x2    // Release pages with MADV_FREE.
+#define CB_TRIMMED 0x4      // Idle pages already released.
+#define CB_COMPRESSED 0x8   // 32-bit offsets from _slotBase stored.
+#define CB_ALLOCATED 0x10   // Memory from a user-supplied allocator.
+#define CB_REPLICATED 0x20  // Primary of a replication: nothing dropped.
+
+// Admission policies.
+#define CB_POLICY_REJECT 0      // Reject new entries if full.
+#define CB_POLICY_DROP_OLDEST 1 // Drop the oldest entries to make room.
+#define CB_POLICY_EARLY_DROP 2  // Reject at random above a fill level.
+#define CB_POLICY_SAMPLE 3      // If full, admit one in N, dropping.
+
+/* A user-supplied allocator: "alloc" returns a block of the given size and
+ * alignment (or NULL), "free" gives back a block of the given size, and
+ * both get "ctx" as their first argument.
+ */
+typedef struct {
+    void *(*alloc)(void *ctx, size_t size, size_t align);
+    void (*free)(void *ctx, void *ptr, size_t size);
+    void *ctx;
+} CBAllocator;
+
 /* A circular buffer is made of a pointer to a data area, its length, and a
  * couple more pointers to the start of the new and old data respectively.
  * Such pointers are generated and managed by the various methods.
  * A counter of the valid entries is also made available.
+ * Buffers with a mapped data area also remember the size of the mapping,
+ * how long they may stay idle before their free pages are released, and the
+ * state they were last seen in, to tell whether they have been idle.
+ * Compressed buffers store 32-bit slots, so their pointers are seen as
+ * such, and remember the base address that the slots are offsets from.
+ * Buffers also hold their admission policy and its state, and count the
+ * entries that were rejected, and those that were dropped from the buffer.
+ * They also count the entries written and read, and the most entries held.
  */
 typedef struct {
-    void **_dataPtr;
+    union {
+        void **_dataPtr;
+        uint32_t *_dataSlots;
+    };
     ulong cbSize;
-    void **_readPtr;
-    void **_writePtr;
+    union {
+        void **_readPtr;
+        uint32_t *_readSlot;
+    };
+    union {
+        void **_writePtr;
+        uint32_t *_writeSlot;
+    };
     ulong dataCount;
+    int _flags;
+    char *_slotBase;
+    ulong _mapSize;
+    uint64_t _idleNs;
+    uint64_t _lastActiveNs;
+    ulong _lastWrites;
+    ulong _lastReads;
+    const CBAllocator *_alloc;
+    int _policy;
+    int _dropFree;
+    ulong _policyParam;
+    ulong _sampleCount;
+    uint64_t _rngState;
+    ulong rejected;
+    ulong dropped;
+    ulong writes;
+    ulong reads;
+    ulong highWater;
 } CircBuffer;
 
 CircBuffer *createCBuffer(ulong cbSize);
+CircBuffer *createCBufferMapped(ulong cbSize, ulong idleMs, int lazyFree);
+CircBuffer *createCBufferCompressed(ulong cbSize, void *base);
+CircBuffer *createCBufferAlloc(ulong cbSize, const CBAllocator *alloc,
+                               int zeroFill);
 void deleteCBuffer(CircBuffer *cBuff, int toFree);
 void *cbRead(CircBuffer *cBuff);
 int cbWrite(CircBuffer *cBuff, void *data);
 ulong cbCopy(CircBuffer *cBuff, void **dataBuf, ulong bufSize, int upTo);
 ulong cbPaste(CircBuffer *cBuff, void **dataBuf, ulong bufSize, int upTo);
+ulong cbTrim(CircBuffer *cBuff);
+ulong cbTrimIdle(CircBuffer *cBuff);
+void cbMemoryUsage(CircBuffer *cBuff, ulong *reserved, ulong *resident);
+int cbSetPolicy(CircBuffer *cBuff, int policy, ulong param, int toFree);
 
 #endif
@@ -0,0 +1,222 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to make parallel bulk transfers between
+ * Circular Buffers and arrays.
+ * See the header file for a general description.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "CircularBufferBulk.h"
+
+// Bulk transfers are recorded like the ones they replace.
+#ifdef CB_TRACE
+#include "CircularBufferTrace.h"
+#define TRACE_OP(op, cBuff, size, upTo) cbTraceRecord(op, cBuff, size, upTo)
+#else
+#define TRACE_OP(op, cBuff, size, upTo)
+#endif
+
+// Chunks are cut on cache line boundaries.
+#define CB_BULK_ALIGN 64UL
+
+/* Transfers chunks of the current transfer until there are none left. */
+static void _cbBulkWork(CBCopyPool *pool) {
+    for (;;) {
+        ulong i = __atomic_fetch_add(&(pool->_nextChunk), 1, __ATOMIC_RELAXED);
+        if (i >= pool->_nChunks) return;
+        CBBulkChunk *chunk = pool->_chunks + i;
+        memcpy(chunk->_dst, chunk->_src, chunk->_len);
+        if (chunk->_clear) memset(chunk->_src, 0, chunk->_len);
+    }
+}
+
+/* Worker threads' body: waits for a transfer to start, helps with it, and
+ * reports when done.
+ */
+static void *_cbBulkWorker(void *arg) {
+    CBCopyPool *pool = arg;
+    ulong seen = 0;
+    pthread_mutex_lock(&(pool->_lock));
+    for (;;) {
+        while ((pool->_gen == seen) && !pool->_stop)
+            pthread_cond_wait(&(pool->_start), &(pool->_lock));
+        if (pool->_stop) break;
+        seen = pool->_gen;
+        pthread_mutex_unlock(&(pool->_lock));
+        _cbBulkWork(pool);
+        pthread_mutex_lock(&(pool->_lock));
+        if (--pool->_busy == 0) pthread_cond_signal(&(pool->_done));
+    }
+    pthread_mutex_unlock(&(pool->_lock));
+    return NULL;
+}
+
+/* Cuts a span of a transfer in chunks of about the given size. */
+static void _cbBulkSplit(CBCopyPool *pool, char *dst, char *src, ulong len,
+                         int clear, ulong chunkSize) {
+    while (len != 0) {
+        ulong size = len < chunkSize ? len : chunkSize;
+        CBBulkChunk *chunk = pool->_chunks + pool->_nChunks++;
+        chunk->_dst = dst;
+        chunk->_src = src;
+        chunk->_len = size;
+        chunk->_clear = clear;
+        dst += size;
+        src += size;
+        len -= size;
+    }
+}
+
+/* Moves one or two spans, the second one possibly empty, with the workers.
+ * Spans are cut so that all threads get a fair share.
+ */
+static void _cbBulkRun(CBCopyPool *pool, char *dst1, char *src1, ulong len1,
+                       char *dst2, char *src2, ulong len2, int clear) {
+    ulong parts = (pool->nThreads + 1) * CB_BULK_CHUNKS;
+    ulong chunkSize = (len1 + len2 + parts - 1) / parts;
+    chunkSize = (chunkSize + CB_BULK_ALIGN - 1) & ~(CB_BULK_ALIGN - 1);
+    pthread_mutex_lock(&(pool->_lock));
+    pool->_nChunks = 0;
+    _cbBulkSplit(pool, dst1, src1, len1, clear, chunkSize);
+    _cbBulkSplit(pool, dst2, src2, len2, clear, chunkSize);
+    pool->_nextChunk = 0;
+    pool->_busy = pool->nThreads;
+    pool->_gen++;
+    pthread_cond_broadcast(&(pool->_start));
+    pthread_mutex_unlock(&(pool->_lock));
+    // Help the workers, then wait for them.
+    _cbBulkWork(pool);
+    pthread_mutex_lock(&(pool->_lock));
+    while (pool->_busy != 0)
+        pthread_cond_wait(&(pool->_done), &(pool->_lock));
+    pthread_mutex_unlock(&(pool->_lock));
+}
+
+/* Creates a new copy pool with the given number of worker threads, which
+ * splits transfers of at least "threshold" entries (CB_BULK_THRESHOLD if 0).
+ */
+CBCopyPool *createCBCopyPool(ulong nThreads, ulong threshold) {
+    if (nThreads == 0) return NULL;  // Sanity check.
+    // Allocate memory for the new structure, its threads and chunks.
+    CBCopyPool *pool = calloc(1, sizeof(CBCopyPool));
+    if (pool == NULL) return NULL;  // calloc failed.
+    pool->_workers = calloc(nThreads, sizeof(pthread_t));
+    // Each span may end up with one more chunk, due to rounding.
+    pool->_chunks = calloc((nThreads + 1) * CB_BULK_CHUNKS + 2,
+                           sizeof(CBBulkChunk));
+    if ((pool->_workers == NULL) || (pool->_chunks == NULL)) {
+        // calloc failed.
+        free(pool->_workers);
+        free(pool->_chunks);
+        free(pool);
+        return NULL;
+    }
+    // Set up the new structure, then start the workers.
+    pool->threshold = threshold == 0 ? CB_BULK_THRESHOLD : threshold;
+    pthread_mutex_init(&(pool->_lock), NULL);
+    pthread_cond_init(&(pool->_start), NULL);
+    pthread_cond_init(&(pool->_done), NULL);
+    pthread_mutex_init(&(pool->_callLock), NULL);
+    for (ulong i = 0; i < nThreads; i++) {
+        if (pthread_create(pool->_workers + i, NULL, _cbBulkWorker,
+                           pool) != 0) {
+            // pthread_create failed: keep the workers started so far.
+            if (i == 0) {
+                deleteCBCopyPool(pool);
+                return NULL;
+            }
+            break;
+        }
+        pool->nThreads++;
+    }
+    return pool;
+}
+
+/* Deletes a copy pool, stopping its worker threads. */
+void deleteCBCopyPool(CBCopyPool *pool) {
+    if (pool == NULL) return;
+    pthread_mutex_lock(&(pool->_lock));
+    pool->_stop = 1;
+    pthread_cond_broadcast(&(pool->_start));
+    pthread_mutex_unlock(&(pool->_lock));
+    for (ulong i = 0; i < pool->nThreads; i++)
+        pthread_join(pool->_workers[i], NULL);
+    pthread_mutex_destroy(&(pool->_lock));
+    pthread_cond_destroy(&(pool->_start));
+    pthread_cond_destroy(&(pool->_done));
+    pthread_mutex_destroy(&(pool->_callLock));
+    free(pool->_workers);
+    free(pool->_chunks);
+    free(pool);
+}
+
+/* Reads a portion of the buffer, placing it in the provided area, like
+ * cbCopy does, with the pool's threads if it's large enough.
+ * Returns the number of read operations performed.
+ */
+ulong cbCopyBulk(CBCopyPool *pool, CircBuffer *cBuff, void **dataBuf,
+                 ulong bufSize, int upTo) {
+    // Sanity checks.
+    if ((dataBuf == NULL) || (bufSize == 0) || (cBuff == NULL)) return 0;
+    ulong ops = upTo && (cBuff->dataCount < bufSize) ? cBuff->dataCount :
+                bufSize;
+    if ((pool == NULL) || (ops < pool->threshold) ||
+        (cBuff->_flags & CB_COMPRESSED) || (ops > cBuff->dataCount))
+        return cbCopy(cBuff, dataBuf, bufSize, upTo);
+    TRACE_OP(CB_OP_COPY, cBuff, bufSize, upTo);
+    // Read data from the buffer, in one or two spans.
+    ulong toEnd = (cBuff->_dataPtr + cBuff->cbSize) - cBuff->_readPtr;
+    ulong first = ops < toEnd ? ops : toEnd;
+    pthread_mutex_lock(&(pool->_callLock));
+    _cbBulkRun(pool, (char *)dataBuf, (char *)cBuff->_readPtr,
+               first * sizeof(void *), (char *)(dataBuf + first),
+               (char *)cBuff->_dataPtr, (ops - first) * sizeof(void *), 1);
+    pthread_mutex_unlock(&(pool->_callLock));
+    cBuff->_readPtr = ops < toEnd ? cBuff->_readPtr + ops :
+                      cBuff->_dataPtr + (ops - toEnd);
+    cBuff->dataCount -= ops;
+    __atomic_store_n(&(cBuff->reads), cBuff->reads + ops, __ATOMIC_RELAXED);
+    return ops;
+}
+
+/* Writes a block of data into the buffer, like cbPaste does, with the pool's
+ * threads if it's large enough.
+ * Returns the number of write operations performed.
+ */
+ulong cbPasteBulk(CBCopyPool *pool, CircBuffer *cBuff, void **dataBuf,
+                  ulong bufSize, int upTo) {
+    // Sanity checks.
+    if ((dataBuf == NULL) || (bufSize == 0) || (cBuff == NULL)) return 0;
+    ulong freeCells = cBuff->cbSize - cBuff->dataCount;
+    ulong ops = upTo && (freeCells < bufSize) ? freeCells : bufSize;
+    if ((pool == NULL) || (ops < pool->threshold) ||
+        (cBuff->_flags & CB_COMPRESSED) || (ops > freeCells) ||
+        (cBuff->_policy != CB_POLICY_REJECT))
+        return cbPaste(cBuff, dataBuf, bufSize, upTo);
+    TRACE_OP(CB_OP_PASTE, cBuff, bufSize, upTo);
+    __atomic_store_n(&(cBuff->rejected), cBuff->rejected + (bufSize - ops),
+                     __ATOMIC_RELAXED);
+    // Write data to the buffer, in one or two spans.
+    ulong toEnd = (cBuff->_dataPtr + cBuff->cbSize) - cBuff->_writePtr;
+    ulong first = ops < toEnd ? ops : toEnd;
+    pthread_mutex_lock(&(pool->_callLock));
+    _cbBulkRun(pool, (char *)cBuff->_writePtr, (char *)dataBuf,
+               first * sizeof(void *), (char *)cBuff->_dataPtr,
+               (char *)(dataBuf + first), (ops - first) * sizeof(void *), 0);
+    pthread_mutex_unlock(&(pool->_callLock));
+    cBuff->_writePtr = ops < toEnd ? cBuff->_writePtr + ops :
+                       cBuff->_dataPtr + (ops - toEnd);
+    cBuff->dataCount += ops;
+    __atomic_store_n(&(cBuff->writes), cBuff->writes + ops, __ATOMIC_RELAXED);
+    if (cBuff->dataCount > cBuff->highWater)
+        __atomic_store_n(&(cBuff->highWater), cBuff->dataCount,
+                         __ATOMIC_RELAXED);
+    return ops;
+}
@@ -0,0 +1,72 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for parallel bulk
+ * transfers between Circular Buffers and arrays.
+ * A single thread copying gigabytes is limited by the memory bandwidth a
+ * core can drive, well below what the whole system can. A copy pool keeps
+ * a few worker threads ready: large copies and pastes are split into
+ * chunks, across the wrap too, which the workers and the calling thread
+ * transfer together. Transfers smaller than the pool's threshold are
+ * handed to cbCopy and cbPaste as they are, since waking the workers would
+ * cost more than it saves.
+ * Semantics are the same as cbCopy and cbPaste. A pool can serve many
+ * buffers, one transfer at a time.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef CIRCBUFBULK_H
+#define CIRCBUFBULK_H
+
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "CircularBuffer.h"
+
+// Default threshold, in entries, for a transfer to be split (8 MB).
+#define CB_BULK_THRESHOLD (1UL << 20)
+
+// Chunks each thread gets per transfer, on average.
+#define CB_BULK_CHUNKS 4
+
+/* A chunk of a transfer: bytes to move, and whether to clear the source
+ * afterwards (when it's the buffer being read).
+ */
+typedef struct {
+    char *_dst;
+    char *_src;
+    ulong _len;
+    int _clear;
+} CBBulkChunk;
+
+/* A copy pool is made of its worker threads, the threshold, the chunks of
+ * the current transfer with the index of the next one to take, and what's
+ * needed to start the workers and wait for them.
+ */
+typedef struct {
+    pthread_t *_workers;
+    ulong nThreads;
+    ulong threshold;
+    CBBulkChunk *_chunks;
+    ulong _nChunks;
+    ulong _nextChunk;
+    ulong _busy;
+    ulong _gen;
+    int _stop;
+    pthread_mutex_t _lock;
+    pthread_cond_t _start;
+    pthread_cond_t _done;
+    pthread_mutex_t _callLock;
+} CBCopyPool;
+
+CBCopyPool *createCBCopyPool(ulong nThreads, ulong threshold);
+void deleteCBCopyPool(CBCopyPool *pool);
+ulong cbCopyBulk(CBCopyPool *pool, CircBuffer *cBuff, void **dataBuf,
+                 ulong bufSize, int upTo);
+ulong cbPasteBulk(CBCopyPool *pool, CircBuffer *cBuff, void **dataBuf,
+                  ulong bufSize, int upTo);
+
+#endif
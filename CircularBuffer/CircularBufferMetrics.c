@@ -0,0 +1,296 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to export Circular Buffer metrics.
+ * See the header file for a general description.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "CircularBufferMetrics.h"
+
+// Listening socket backlog.
+#define METRICS_BACKLOG 16
+
+/* Exported metrics, in the order they're listed in. */
+static const struct {
+    const char *name;
+    const char *type;
+    const char *help;
+} metrics[] = {
+    {"cb_entries", "gauge", "Entries held by the ring."},
+    {"cb_size", "gauge", "Entries the ring can hold."},
+    {"cb_high_water", "gauge", "Most entries ever held by the ring."},
+    {"cb_writes_total", "counter", "Entries written to the ring."},
+    {"cb_reads_total", "counter", "Entries read from the ring."},
+    {"cb_rejected_total", "counter",
+     "Entries rejected because the ring was full or by its policy."},
+    {"cb_dropped_total", "counter",
+     "Old entries dropped by the ring's policy to make room."}
+};
+
+/* Reads the monotonic clock, in nanoseconds. */
+static inline uint64_t _metricsNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Reads a metric of a buffer, without locks. */
+static ulong _metricsValue(CircBuffer *cBuff, int metric) {
+    switch (metric) {
+        case 0:
+            return __atomic_load_n(&(cBuff->dataCount), __ATOMIC_RELAXED);
+        case 1:
+            return cBuff->cbSize;
+        case 2:
+            return __atomic_load_n(&(cBuff->highWater), __ATOMIC_RELAXED);
+        case 3:
+            return __atomic_load_n(&(cBuff->writes), __ATOMIC_RELAXED);
+        case 4:
+            return __atomic_load_n(&(cBuff->reads), __ATOMIC_RELAXED);
+        case 5:
+            return __atomic_load_n(&(cBuff->rejected), __ATOMIC_RELAXED);
+        default:
+            return __atomic_load_n(&(cBuff->dropped), __ATOMIC_RELAXED);
+    }
+}
+
+/* Writes a label value, escaped as the text format requires. */
+static void _metricsLabel(FILE *out, const char *value) {
+    for (; *value != '\0'; value++) {
+        if (*value == '\n') fputs("\\n", out);
+        else if ((*value == '\\') || (*value == '"')) fprintf(out, "\\%c",
+                                                               *value);
+        else fputc(*value, out);
+    }
+}
+
+/* Takes a snapshot of the registered buffers, replacing the last one. */
+static void _metricsSnapshot(CBExporter *exporter) {
+    char *page = NULL;
+    size_t pageLen = 0;
+    FILE *out = open_memstream(&page, &pageLen);
+    if (out == NULL) return;  // open_memstream failed.
+    pthread_mutex_lock(&(exporter->_lock));
+    for (int m = 0; m < (int)(sizeof(metrics) / sizeof(metrics[0])); m++) {
+        fprintf(out, "# HELP %s %s\n# TYPE %s %s\n", metrics[m].name,
+                metrics[m].help, metrics[m].name, metrics[m].type);
+        for (ulong i = 0; i < exporter->_ringCount; i++) {
+            fprintf(out, "%s{ring=\"", metrics[m].name);
+            _metricsLabel(out, exporter->_rings[i]._name);
+            fprintf(out, "\"} %lu\n",
+                    _metricsValue(exporter->_rings[i]._cBuff, m));
+        }
+    }
+    pthread_mutex_unlock(&(exporter->_lock));
+    if (fclose(out) != 0) {
+        // Out of memory: keep the last snapshot.
+        free(page);
+        return;
+    }
+    free(exporter->_page);
+    exporter->_page = page;
+    exporter->_pageLen = pageLen;
+}
+
+/* Sends a whole block of data to a client.
+ * Returns 1 on success, 0 otherwise.
+ */
+static int _metricsSend(int fd, const char *data, size_t len) {
+    while (len != 0) {
+        ssize_t res = send(fd, data, len, MSG_NOSIGNAL);
+        if (res < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        data += res;
+        len -= (size_t)res;
+    }
+    return 1;
+}
+
+/* Accepts a client and sends it the last snapshot. */
+static void _metricsServe(CBExporter *exporter) {
+    int fd = accept4(exporter->_listenFd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0) return;  // accept4 failed.
+    struct timeval timeout = {0, CB_METRICS_IO_MS * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    // See if the client sends an HTTP request.
+    char request[512];
+    int http = 0;
+    struct pollfd pfd = {fd, POLLIN, 0};
+    if (poll(&pfd, 1, CB_METRICS_IO_MS) > 0) {
+        ssize_t res = recv(fd, request, sizeof(request), MSG_DONTWAIT);
+        http = (res >= 4) && (memcmp(request, "GET ", 4) == 0);
+    }
+    if (http) {
+        char header[160];
+        int len = snprintf(header, sizeof(header),
+                           "HTTP/1.0 200 OK\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: %zu\r\n\r\n", exporter->_pageLen);
+        if (!_metricsSend(fd, header, (size_t)len)) {
+            close(fd);
+            return;
+        }
+    }
+    _metricsSend(fd, exporter->_page, exporter->_pageLen);
+    close(fd);
+}
+
+/* Exporter thread: takes snapshots and serves clients until stopped. */
+static void *_metricsThread(void *arg) {
+    CBExporter *exporter = arg;
+    uint64_t periodNs = (uint64_t)exporter->periodMs * 1000000ULL;
+    uint64_t next = _metricsNow();
+    for (;;) {
+        uint64_t now = _metricsNow();
+        if (now >= next) {
+            _metricsSnapshot(exporter);
+            next = now + periodNs;
+        }
+        struct pollfd pfds[2] = {{exporter->_listenFd, POLLIN, 0},
+                                 {exporter->_stopFd, POLLIN, 0}};
+        int res = poll(pfds, 2, (int)((next - now) / 1000000ULL) + 1);
+        if ((res < 0) && (errno != EINTR)) break;  // poll failed.
+        if (res <= 0) continue;
+        if (pfds[1].revents != 0) break;  // Stop requested.
+        if (pfds[0].revents & POLLIN) _metricsServe(exporter);
+    }
+    return NULL;
+}
+
+/* Creates a new exporter, listening on a Unix socket at the given path
+ * (a stale socket there is replaced), which takes a snapshot of the
+ * registered buffers every "periodMs" milliseconds.
+ */
+CBExporter *createCBExporter(const char *path, ulong periodMs) {
+    // Sanity checks.
+    struct sockaddr_un addr;
+    if ((path == NULL) || (strlen(path) >= sizeof(addr.sun_path)) ||
+        (periodMs == 0) || (periodMs > INT32_MAX)) return NULL;
+    CBExporter *exporter = calloc(1, sizeof(CBExporter));
+    if (exporter == NULL) return NULL;  // calloc failed.
+    exporter->periodMs = periodMs;
+    exporter->_path = strdup(path);
+    exporter->_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    exporter->_stopFd = eventfd(0, EFD_CLOEXEC);
+    if ((exporter->_path == NULL) || (exporter->_listenFd < 0) ||
+        (exporter->_stopFd < 0)) goto fail;
+    // Bind the socket, replacing a stale one.
+    struct stat st;
+    if ((lstat(path, &st) == 0) && S_ISSOCK(st.st_mode)) unlink(path);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (bind(exporter->_listenFd, (struct sockaddr *)&addr,
+             sizeof(addr)) != 0) goto fail;
+    // From now on, the socket file must be removed upon failure.
+    if (listen(exporter->_listenFd, METRICS_BACKLOG) != 0) goto failBound;
+    pthread_mutex_init(&(exporter->_lock), NULL);
+    if (pthread_create(&(exporter->_thread), NULL, _metricsThread,
+                       exporter) != 0) {
+        pthread_mutex_destroy(&(exporter->_lock));
+        goto failBound;
+    }
+    return exporter;
+failBound:
+    unlink(path);
+fail:
+    if (exporter->_listenFd >= 0) close(exporter->_listenFd);
+    if (exporter->_stopFd >= 0) close(exporter->_stopFd);
+    free(exporter->_path);
+    free(exporter);
+    return NULL;
+}
+
+/* Stops and deletes an exporter, removing its socket. Buffers that are
+ * still registered are left alone.
+ */
+void deleteCBExporter(CBExporter *exporter) {
+    if (exporter == NULL) return;
+    uint64_t one = 1;
+    while ((write(exporter->_stopFd, &one, sizeof(one)) < 0) &&
+           (errno == EINTR));
+    pthread_join(exporter->_thread, NULL);
+    close(exporter->_listenFd);
+    close(exporter->_stopFd);
+    unlink(exporter->_path);
+    pthread_mutex_destroy(&(exporter->_lock));
+    for (ulong i = 0; i < exporter->_ringCount; i++)
+        free(exporter->_rings[i]._name);
+    free(exporter->_rings);
+    free(exporter->_page);
+    free(exporter->_path);
+    free(exporter);
+}
+
+/* Registers a buffer with an exporter, labelling its metrics with the given
+ * name (which is copied).
+ * Returns 1 on success, 0 otherwise.
+ */
+int cbExportRing(CBExporter *exporter, CircBuffer *cBuff, const char *name) {
+    // Sanity checks.
+    if ((exporter == NULL) || (cBuff == NULL) || (name == NULL)) return 0;
+    char *nameCopy = strdup(name);
+    if (nameCopy == NULL) return 0;  // strdup failed.
+    pthread_mutex_lock(&(exporter->_lock));
+    if (exporter->_ringCount == exporter->_ringCap) {
+        ulong newCap = exporter->_ringCap == 0 ? 8 : exporter->_ringCap * 2;
+        CBMetricsRing *newRings = realloc(exporter->_rings,
+                                          newCap * sizeof(CBMetricsRing));
+        if (newRings == NULL) {
+            // realloc failed.
+            pthread_mutex_unlock(&(exporter->_lock));
+            free(nameCopy);
+            return 0;
+        }
+        exporter->_rings = newRings;
+        exporter->_ringCap = newCap;
+    }
+    exporter->_rings[exporter->_ringCount]._cBuff = cBuff;
+    exporter->_rings[exporter->_ringCount]._name = nameCopy;
+    exporter->_ringCount++;
+    pthread_mutex_unlock(&(exporter->_lock));
+    return 1;
+}
+
+/* Unregisters a buffer from an exporter: once this returns, the exporter
+ * won't touch it anymore.
+ * Returns 1 on success, 0 if the buffer wasn't registered.
+ */
+int cbUnexportRing(CBExporter *exporter, CircBuffer *cBuff) {
+    if ((exporter == NULL) || (cBuff == NULL)) return 0;  // Sanity check.
+    int found = 0;
+    pthread_mutex_lock(&(exporter->_lock));
+    for (ulong i = 0; i < exporter->_ringCount; i++) {
+        if (exporter->_rings[i]._cBuff != cBuff) continue;
+        free(exporter->_rings[i]._name);
+        // Keep the remaining buffers in order.
+        memmove(exporter->_rings + i, exporter->_rings + i + 1,
+                (exporter->_ringCount - i - 1) * sizeof(CBMetricsRing));
+        exporter->_ringCount--;
+        found = 1;
+        break;
+    }
+    pthread_mutex_unlock(&(exporter->_lock));
+    return found;
+}
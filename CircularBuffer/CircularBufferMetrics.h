@@ -0,0 +1,67 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the optional
+ * Circular Buffer metrics exporter.
+ * An exporter owns a thread that periodically takes a snapshot of the
+ * counters of the buffers registered with it (entries held, size,
+ * high-water mark, entries written, read, rejected and dropped), and serves
+ * the latest one in the Prometheus text format on a local Unix socket.
+ * Counters are read without locks, with relaxed atomic loads, so the
+ * threads using the buffers are never held back; values in a snapshot may
+ * thus be a little stale, and not exactly consistent with one another.
+ * The count of entries held is updated with plain stores, which word-sized
+ * loads can't see torn on the supported platforms, but which a race
+ * detector will still report.
+ * Scrapes are served from the last snapshot and never touch the buffers.
+ * Clients that send an HTTP GET request (e.g. curl --unix-socket) get an
+ * HTTP response, other ones just get the text after a short wait.
+ * Buffers must be unregistered before they are deleted.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef CIRCBUFMETRICS_H
+#define CIRCBUFMETRICS_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "CircularBuffer.h"
+
+// Time given to clients to send a request, and to take the answer.
+#define CB_METRICS_IO_MS 100
+
+/* A registered buffer, with the name it's labelled with. */
+typedef struct {
+    CircBuffer *_cBuff;
+    char *_name;
+} CBMetricsRing;
+
+/* An exporter is made of its listening socket and path, a descriptor to
+ * stop its thread with, the snapshot period, the registered buffers (with
+ * a lock that guards them) and the text of the last snapshot.
+ */
+typedef struct {
+    int _listenFd;
+    int _stopFd;
+    char *_path;
+    ulong periodMs;
+    pthread_t _thread;
+    pthread_mutex_t _lock;
+    CBMetricsRing *_rings;
+    ulong _ringCount;
+    ulong _ringCap;
+    char *_page;
+    size_t _pageLen;
+} CBExporter;
+
+CBExporter *createCBExporter(const char *path, ulong periodMs);
+void deleteCBExporter(CBExporter *exporter);
+int cbExportRing(CBExporter *exporter, CircBuffer *cBuff, const char *name);
+int cbUnexportRing(CBExporter *exporter, CircBuffer *cBuff);
+
+#endif
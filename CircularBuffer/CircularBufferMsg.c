@@ -0,0 +1,146 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to transfer datagrams between Circular
+ * Buffers and sockets in batches.
+ * See the header file for a general description.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "CircularBufferMsg.h"
+
+/* Returns the i-th oldest entry of a buffer, without removing it. */
+static inline void *_cbPeek(CircBuffer *cBuff, ulong i) {
+    if (cBuff->_flags & CB_COMPRESSED) {
+        ulong toEnd = (ulong)((cBuff->_dataSlots + cBuff->cbSize) -
+                              cBuff->_readSlot);
+        uint32_t slot = i < toEnd ? cBuff->_readSlot[i] :
+                        cBuff->_dataSlots[i - toEnd];
+        return cBuff->_slotBase + slot;
+    }
+    ulong toEnd = (ulong)((cBuff->_dataPtr + cBuff->cbSize) -
+                          cBuff->_readPtr);
+    return i < toEnd ? cBuff->_readPtr[i] : cBuff->_dataPtr[i - toEnd];
+}
+
+/* Sets up a message header for a datagram. */
+static inline void _cbSetHeader(struct mmsghdr *msg, struct iovec *iov,
+                                CBDatagram *dgram, size_t size) {
+    iov->iov_base = dgram->data;
+    iov->iov_len = size;
+    memset(&(msg->msg_hdr), 0, sizeof(struct msghdr));
+    msg->msg_hdr.msg_iov = iov;
+    msg->msg_hdr.msg_iovlen = 1;
+    msg->msg_len = 0;
+}
+
+/* Sends up to the given number of datagrams queued in a buffer, with as
+ * few system calls as possible, removing the ones that were sent.
+ * Sent descriptors are placed in "sentBuf", if given, so that they can be
+ * reused; it must have room for "maxMsgs" entries.
+ * The number of system calls made is stored in "calls", if not NULL.
+ * Returns the number of datagrams sent.
+ */
+ulong cbSendMMsg(CircBuffer *cBuff, int sockfd, ulong maxMsgs, int flags,
+                 void **sentBuf, ulong *calls) {
+    if (calls != NULL) *calls = 0;
+    // Sanity checks.
+    if ((cBuff == NULL) || (sockfd < 0) || (maxMsgs == 0)) return 0;
+    struct mmsghdr msgs[CB_MMSG_BATCH];
+    struct iovec iovs[CB_MMSG_BATCH];
+    void *sent[CB_MMSG_BATCH];
+    ulong total = 0;
+    while ((total < maxMsgs) && (cBuff->dataCount != 0)) {
+        // Build a batch from the oldest datagrams.
+        ulong batch = maxMsgs - total;
+        if (batch > cBuff->dataCount) batch = cBuff->dataCount;
+        if (batch > CB_MMSG_BATCH) batch = CB_MMSG_BATCH;
+        for (ulong i = 0; i < batch; i++) {
+            CBDatagram *dgram = _cbPeek(cBuff, i);
+            _cbSetHeader(msgs + i, iovs + i, dgram, dgram->len);
+            if (dgram->addrLen != 0) {
+                msgs[i].msg_hdr.msg_name = &(dgram->addr);
+                msgs[i].msg_hdr.msg_namelen = dgram->addrLen;
+            }
+        }
+        int res = sendmmsg(sockfd, msgs, (unsigned int)batch, flags);
+        if (calls != NULL) (*calls)++;
+        if (res <= 0) break;
+        // Advance the buffer by the datagrams actually sent.
+        cbCopy(cBuff, sentBuf != NULL ? sentBuf + total : sent,
+               (ulong)res, 0);
+        total += (ulong)res;
+        if ((ulong)res < batch) break;  // The socket can't take more now.
+    }
+    return total;
+}
+
+/* Receives up to the given number of datagrams into the free descriptors
+ * supplied, and queues the filled ones in a buffer, with as few system
+ * calls as possible. Only the first call may block, as per the socket and
+ * the flags given, and only until a datagram arrives (MSG_WAITFORONE).
+ * Filled descriptors are taken from the start of "freeDescs", and get the
+ * length of the received datagram and the sender's address.
+ * If the buffer doesn't take all the datagrams received (e.g. because of
+ * its admission policy), the ones left out follow the queued ones in
+ * "freeDescs", filled in, and their number is stored in "notQueued" (if
+ * not NULL), so that the caller can handle them.
+ * The number of system calls made is stored in "calls", if not NULL.
+ * Returns the number of datagrams received and queued.
+ */
+ulong cbRecvMMsg(CircBuffer *cBuff, int sockfd, void **freeDescs,
+                 ulong nDescs, int flags, ulong *notQueued, ulong *calls) {
+    if (notQueued != NULL) *notQueued = 0;
+    if (calls != NULL) *calls = 0;
+    // Sanity checks.
+    if ((cBuff == NULL) || (sockfd < 0) || (freeDescs == NULL) ||
+        (nDescs == 0)) return 0;
+    struct mmsghdr msgs[CB_MMSG_BATCH];
+    struct iovec iovs[CB_MMSG_BATCH];
+    ulong total = 0;
+    for (;;) {
+        // Build a batch from the free descriptors, as long as there's room
+        // in the buffer.
+        ulong batch = nDescs - total;
+        ulong freeCells = cBuff->cbSize - cBuff->dataCount;
+        if (batch > freeCells) batch = freeCells;
+        if (batch > CB_MMSG_BATCH) batch = CB_MMSG_BATCH;
+        if (batch == 0) break;
+        for (ulong i = 0; i < batch; i++) {
+            CBDatagram *dgram = freeDescs[total + i];
+            _cbSetHeader(msgs + i, iovs + i, dgram, dgram->capacity);
+            msgs[i].msg_hdr.msg_name = &(dgram->addr);
+            msgs[i].msg_hdr.msg_namelen = sizeof(dgram->addr);
+        }
+        int res = recvmmsg(sockfd, msgs, (unsigned int)batch,
+                           total == 0 ? (flags | MSG_WAITFORONE)
+                                      : (flags | MSG_DONTWAIT),
+                           NULL);
+        if (calls != NULL) (*calls)++;
+        if (res <= 0) break;
+        for (int i = 0; i < res; i++) {
+            CBDatagram *dgram = freeDescs[total + (ulong)i];
+            dgram->len = msgs[i].msg_len;
+            dgram->addrLen = msgs[i].msg_hdr.msg_namelen;
+        }
+        // Queue the datagrams actually received.
+        ulong queued = cbPaste(cBuff, freeDescs + total, (ulong)res, 1);
+        total += queued;
+        if (queued < (ulong)res) {
+            // The buffer didn't take them all: hand the rest back.
+            if (notQueued != NULL) *notQueued = (ulong)res - queued;
+            break;
+        }
+        if ((ulong)res < batch) break;  // Nothing more to read now.
+    }
+    return total;
+}
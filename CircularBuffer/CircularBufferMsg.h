@@ -0,0 +1,52 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for batched datagram
+ * transfers between Circular Buffers and sockets.
+ * Buffers hold pointers to datagram descriptors. Instead of sending or
+ * receiving one datagram per system call, these routines build the message
+ * headers for sendmmsg(2) and recvmmsg(2) directly from many queued
+ * descriptors (across the wrap too), and then advance the buffer by the
+ * number of datagrams actually transferred.
+ * Descriptors are owned by the caller: the ones that have been sent are
+ * handed back so that they can be reused, and receiving fills in free
+ * descriptors supplied by the caller before queueing them.
+ * Errors are reported by transferring nothing, with errno left as set by
+ * the failed system call.
+ * Both routines can store the number of system calls they made, failed and
+ * short ones included, so that callers can tell what batching saved.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef CIRCBUFMSG_H
+#define CIRCBUFMSG_H
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include "CircularBuffer.h"
+
+// Maximum number of datagrams transferred by a single system call.
+#define CB_MMSG_BATCH 64
+
+/* A datagram descriptor: its payload buffer, with the number of valid bytes
+ * and the total capacity (for receiving), and the peer address (addrLen is
+ * 0 for connected sockets).
+ */
+typedef struct {
+    void *data;
+    size_t len;
+    size_t capacity;
+    struct sockaddr_storage addr;
+    socklen_t addrLen;
+} CBDatagram;
+
+ulong cbSendMMsg(CircBuffer *cBuff, int sockfd, ulong maxMsgs, int flags,
+                 void **sentBuf, ulong *calls);
+ulong cbRecvMMsg(CircBuffer *cBuff, int sockfd, void **freeDescs,
+                 ulong nDescs, int flags, ulong *notQueued, ulong *calls);
+
+#endif
@@ -0,0 +1,244 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to replicate Circular Buffers to a follower
+ * process over a TCP connection.
+ * See the header file for a general description.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "CircularBufferRepl.h"
+
+// Size of a replicated entry.
+#define CB_REPL_ENTRY sizeof(void *)
+
+/* Tells whether a failed socket operation can be retried later. */
+static inline int _cbReplRetry(void) {
+    return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+}
+
+/* Removes the given number of (acknowledged) entries from a buffer. */
+static void _cbReplDiscard(CircBuffer *cBuff, ulong n) {
+    void *scratch[64];
+    while (n != 0) {
+        ulong chunk = n < 64 ? n : 64;
+        cbCopy(cBuff, scratch, chunk, 0);
+        n -= chunk;
+    }
+}
+
+/* Follower side: sends the acknowledgement for the entries applied so far,
+ * finishing the one previously sent in part first, if any.
+ */
+static void _cbReplAck(CBReplFollower *foll) {
+    for (;;) {
+        if (foll->_ackOutBytes == 0) {
+            if (foll->applied == foll->_ackedSent) return;
+            foll->_ackOut = foll->applied;
+            foll->_ackOutBytes = sizeof(uint64_t);
+        }
+        char *ackStart = (char *)&(foll->_ackOut) +
+                         (sizeof(uint64_t) - foll->_ackOutBytes);
+        ssize_t res = send(foll->_sockfd, ackStart, foll->_ackOutBytes,
+                           MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (res < 0) {
+            if (!_cbReplRetry()) foll->connected = 0;
+            return;
+        }
+        foll->_ackOutBytes -= (ulong)res;
+        if (foll->_ackOutBytes != 0) return;  // Socket full, go on later.
+        foll->_ackedSent = foll->_ackOut;
+    }
+}
+
+/* Sets up the primary side of a replication, for a buffer whose entries
+ * have to be streamed to the follower connected to the given socket.
+ * Entries already in the buffer are sent too. The buffer must not have an
+ * admission policy that drops entries, and can't be given one until the
+ * primary is deleted.
+ */
+CBReplPrimary *createReplPrimary(CircBuffer *cBuff, int sockfd) {
+    // Sanity checks.
+    if ((cBuff == NULL) || (cBuff->_flags & (CB_COMPRESSED | CB_REPLICATED)) ||
+        (cBuff->_policy == CB_POLICY_DROP_OLDEST) ||
+        (cBuff->_policy == CB_POLICY_SAMPLE) || (sockfd < 0)) return NULL;
+    CBReplPrimary *prim = calloc(1, sizeof(CBReplPrimary));
+    if (prim == NULL) return NULL;  // calloc failed.
+    cBuff->_flags |= CB_REPLICATED;
+    prim->_cBuff = cBuff;
+    prim->_sockfd = sockfd;
+    prim->connected = 1;
+    return prim;
+}
+
+/* Deletes the primary side of a replication. Entries not acknowledged yet
+ * remain in the buffer.
+ */
+void deleteReplPrimary(CBReplPrimary *prim) {
+    if (prim == NULL) return;
+    prim->_cBuff->_flags &= ~CB_REPLICATED;
+    free(prim);
+}
+
+/* Sends as many of the entries not sent yet as the socket accepts, with a
+ * single gather write from the buffer's data area.
+ * Returns the number of entries whose sending was completed.
+ */
+ulong cbReplSend(CBReplPrimary *prim) {
+    if ((prim == NULL) || !prim->connected) return 0;  // Sanity check.
+    CircBuffer *cBuff = prim->_cBuff;
+    ulong total = cBuff->dataCount * CB_REPL_ENTRY;
+    if (prim->_sentBytes >= total) return 0;  // Nothing new.
+    // Find the bytes to send, in one or two spans.
+    ulong areaSize = cBuff->cbSize * CB_REPL_ENTRY;
+    char *area = (char *)cBuff->_dataPtr;
+    ulong startOff = (ulong)((char *)cBuff->_readPtr - area) +
+                     prim->_sentBytes;
+    if (startOff >= areaSize) startOff -= areaSize;
+    ulong toSend = total - prim->_sentBytes;
+    ulong toEnd = areaSize - startOff;
+    struct iovec iovs[2];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iovs;
+    iovs[0].iov_base = area + startOff;
+    if (toSend > toEnd) {
+        iovs[0].iov_len = toEnd;
+        iovs[1].iov_base = area;
+        iovs[1].iov_len = toSend - toEnd;
+        msg.msg_iovlen = 2;
+    } else {
+        iovs[0].iov_len = toSend;
+        msg.msg_iovlen = 1;
+    }
+    ssize_t res = sendmsg(prim->_sockfd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (res < 0) {
+        if (!_cbReplRetry()) prim->connected = 0;
+        return 0;
+    }
+    ulong before = prim->_sentBytes / CB_REPL_ENTRY;
+    prim->_sentBytes += (ulong)res;
+    return (prim->_sentBytes / CB_REPL_ENTRY) - before;
+}
+
+/* Receives the acknowledgements sent by the follower, if any, and removes
+ * the acknowledged entries from the buffer.
+ * Returns the number of entries removed.
+ */
+ulong cbReplPollAcks(CBReplPrimary *prim) {
+    if ((prim == NULL) || !prim->connected) return 0;  // Sanity check.
+    ulong removed = 0;
+    for (;;) {
+        char *ackStart = (char *)&(prim->_ackBuf) + prim->_ackBytes;
+        ssize_t res = recv(prim->_sockfd, ackStart,
+                           sizeof(uint64_t) - prim->_ackBytes, MSG_DONTWAIT);
+        if ((res == 0) || ((res < 0) && !_cbReplRetry())) {
+            // Connection closed or failed.
+            prim->connected = 0;
+            break;
+        }
+        if (res < 0) break;  // No more acknowledgements for now.
+        prim->_ackBytes += (ulong)res;
+        if (prim->_ackBytes < sizeof(uint64_t)) continue;
+        prim->_ackBytes = 0;
+        // Acknowledgements can't go back, nor past what was sent.
+        uint64_t newAcks = prim->_ackBuf - prim->acked;
+        if ((prim->_ackBuf < prim->acked) ||
+            (newAcks > prim->_sentBytes / CB_REPL_ENTRY)) {
+            prim->connected = 0;
+            break;
+        }
+        _cbReplDiscard(prim->_cBuff, (ulong)newAcks);
+        prim->_sentBytes -= (ulong)newAcks * CB_REPL_ENTRY;
+        prim->acked = prim->_ackBuf;
+        removed += (ulong)newAcks;
+    }
+    return removed;
+}
+
+/* Returns the number of entries in the buffer that have been sent (even in
+ * part) but not acknowledged yet.
+ */
+ulong cbReplUnacked(CBReplPrimary *prim) {
+    if (prim == NULL) return 0;
+    return (prim->_sentBytes + CB_REPL_ENTRY - 1) / CB_REPL_ENTRY;
+}
+
+/* Sets up the follower side of a replication, that applies the entries
+ * received from the given socket to a buffer, acknowledging them at least
+ * every "ackBatch" entries (and whenever the socket has been drained).
+ */
+CBReplFollower *createReplFollower(CircBuffer *cBuff, int sockfd,
+                                   ulong ackBatch) {
+    // Sanity checks.
+    if ((cBuff == NULL) || (cBuff->_flags & CB_COMPRESSED) || (sockfd < 0) ||
+        (ackBatch == 0)) return NULL;
+    CBReplFollower *foll = calloc(1, sizeof(CBReplFollower));
+    if (foll == NULL) return NULL;  // calloc failed.
+    foll->_cBuff = cBuff;
+    foll->_sockfd = sockfd;
+    foll->connected = 1;
+    foll->_ackBatch = ackBatch;
+    return foll;
+}
+
+/* Deletes the follower side of a replication. */
+void deleteReplFollower(CBReplFollower *foll) {
+    free(foll);
+}
+
+/* Receives entries from the primary, as long as there are some and the
+ * buffer has room for them, pastes them in the buffer and acknowledges
+ * them. Entries that the buffer doesn't take (e.g. because of its
+ * admission policy) stay staged, and are pasted first by the next call.
+ * Returns the number of entries applied.
+ */
+ulong cbReplApply(CBReplFollower *foll) {
+    if ((foll == NULL) || !foll->connected) return 0;  // Sanity check.
+    CircBuffer *cBuff = foll->_cBuff;
+    ulong count = 0;
+    int drained = 0;
+    for (;;) {
+        // Apply the whole entries staged, as far as the buffer takes them,
+        // and keep the rest (and the partial one).
+        ulong n = foll->_stageBytes / CB_REPL_ENTRY;
+        ulong done = n != 0 ? cbPaste(cBuff, foll->_stage, n, 1) : 0;
+        if (done != 0) {
+            foll->_stageBytes -= done * CB_REPL_ENTRY;
+            memmove(foll->_stage, foll->_stage + done, foll->_stageBytes);
+            foll->applied += done;
+            count += done;
+            if (foll->applied - foll->_ackedSent >= foll->_ackBatch)
+                _cbReplAck(foll);
+        }
+        if ((done < n) || drained) break;  // Go on later.
+        // Receive no more entries than there's room for.
+        ulong room = cBuff->cbSize - cBuff->dataCount;
+        if (room > CB_REPL_BATCH) room = CB_REPL_BATCH;
+        if (room == 0) break;  // Full buffer, go on later.
+        ulong wanted = (room * CB_REPL_ENTRY) - foll->_stageBytes;
+        ssize_t res = recv(foll->_sockfd,
+                           (char *)foll->_stage + foll->_stageBytes,
+                           wanted, MSG_DONTWAIT);
+        if ((res == 0) || ((res < 0) && !_cbReplRetry())) {
+            // Connection closed or failed.
+            foll->connected = 0;
+            break;
+        }
+        if (res < 0) break;  // Drained.
+        foll->_stageBytes += (ulong)res;
+        drained = (ulong)res < wanted;
+    }
+    // Acknowledge what's left, since no more is coming for now.
+    if (foll->connected) _cbReplAck(foll);
+    return count;
+}
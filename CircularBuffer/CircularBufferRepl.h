@@ -0,0 +1,87 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the replication
+ * of a Circular Buffer to a follower process over a TCP connection.
+ * On the primary side, entries written in the buffer are streamed to the
+ * follower straight from the buffer's data area, in as few writes as
+ * possible (one gather write covers both spans across the wrap). Entries
+ * that have been sent are kept in the buffer until the follower
+ * acknowledges them, and only then removed: the primary's read position is
+ * thus driven by acknowledgements, and writers find the buffer full if the
+ * follower lags too much behind.
+ * On the follower side, received entries are pasted into the follower's
+ * own buffer, and acknowledged in batches, by sending the total number of
+ * entries applied so far.
+ * Entries are replicated as they are, as raw "void *" values in the
+ * machine's byte order: they should not be pointers, unless both processes
+ * can make sense of them. Compressed buffers are not supported.
+ * Admission policies that drop old entries would remove entries that are
+ * still being sent, so they are refused on primary buffers. Other policies
+ * only reject new entries, and apply on both sides: followers keep what
+ * their buffer doesn't take, and paste it later.
+ * Sockets are used without blocking, so both sides are meant to be driven
+ * by the caller's own loop (e.g. with poll(2)), by the thread that uses
+ * the buffer. Sockets and buffers remain owned by the caller.
+ * If the connection fails, "connected" is cleared and nothing else is
+ * transferred.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef CIRCBUFREPL_H
+#define CIRCBUFREPL_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "CircularBuffer.h"
+
+// Entries received by a follower per system call, at most.
+#define CB_REPL_BATCH 256
+
+/* The primary side of a replication is made of the buffer and the socket,
+ * the number of bytes already sent past the oldest entry, the number of
+ * entries acknowledged so far, and the partially received acknowledgement.
+ */
+typedef struct {
+    CircBuffer *_cBuff;
+    int _sockfd;
+    int connected;
+    ulong _sentBytes;
+    uint64_t acked;
+    uint64_t _ackBuf;
+    ulong _ackBytes;
+} CBReplPrimary;
+
+/* The follower side of a replication is made of the buffer and the socket,
+ * the acknowledgement batch size, the number of entries applied and of those
+ * acknowledged so far, the acknowledgement being sent, and a staging area
+ * for the entries received, with a partial entry possibly at its end.
+ */
+typedef struct {
+    CircBuffer *_cBuff;
+    int _sockfd;
+    int connected;
+    ulong _ackBatch;
+    uint64_t applied;
+    uint64_t _ackedSent;
+    uint64_t _ackOut;
+    ulong _ackOutBytes;
+    ulong _stageBytes;
+    void *_stage[CB_REPL_BATCH];
+} CBReplFollower;
+
+CBReplPrimary *createReplPrimary(CircBuffer *cBuff, int sockfd);
+void deleteReplPrimary(CBReplPrimary *prim);
+ulong cbReplSend(CBReplPrimary *prim);
+ulong cbReplPollAcks(CBReplPrimary *prim);
+ulong cbReplUnacked(CBReplPrimary *prim);
+CBReplFollower *createReplFollower(CircBuffer *cBuff, int sockfd,
+                                   ulong ackBatch);
+void deleteReplFollower(CBReplFollower *foll);
+ulong cbReplApply(CBReplFollower *foll);
+
+#endif
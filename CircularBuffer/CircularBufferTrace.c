@@ -0,0 +1,157 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to record and load Circular Buffer operation
+ * traces. See the header file for a general description.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "CircularBufferTrace.h"
+
+// Number of records collected in memory before they're flushed.
+#define TRACE_BLOCK 4096
+
+/* The recorder state: only one recording can be active at a time. */
+static struct {
+    pthread_mutex_t lock;
+    int active;
+    FILE *file;
+    CircBuffer *onlyBuff;
+    uint64_t startNs;
+    CBTraceRecord block[TRACE_BLOCK];
+    ulong blockCount;
+} recorder = {PTHREAD_MUTEX_INITIALIZER, 0, NULL, NULL, 0, {{0}}, 0};
+
+// Thread ids are assigned on first use, starting from 1.
+static uint16_t nextThreadId = 1;
+static __thread uint16_t threadId = 0;
+
+/* Reads the monotonic clock, in nanoseconds. */
+static inline uint64_t _traceNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Writes the collected records to the trace file. Must hold the lock. */
+static void _traceFlush(void) {
+    if (recorder.blockCount == 0) return;
+    fwrite(recorder.block, sizeof(CBTraceRecord), recorder.blockCount,
+           recorder.file);
+    recorder.blockCount = 0;
+}
+
+/* Starts recording to the given file, which is overwritten.
+ * If a buffer is given, only its operations are recorded.
+ * Returns 1 on success, 0 on failure or if a recording is already active.
+ */
+int cbTraceStart(const char *path, CircBuffer *onlyBuff) {
+    if (path == NULL) return 0;  // Sanity check.
+    pthread_mutex_lock(&(recorder.lock));
+    if (recorder.active) {
+        pthread_mutex_unlock(&(recorder.lock));
+        return 0;
+    }
+    recorder.file = fopen(path, "wb");
+    if (recorder.file == NULL) {
+        pthread_mutex_unlock(&(recorder.lock));
+        return 0;
+    }
+    CBTraceHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CB_TRACE_MAGIC, sizeof(header.magic));
+    header.recordSize = sizeof(CBTraceRecord);
+    fwrite(&header, sizeof(header), 1, recorder.file);
+    __atomic_store_n(&(recorder.onlyBuff), onlyBuff, __ATOMIC_RELAXED);
+    recorder.blockCount = 0;
+    recorder.startNs = _traceNow();
+    __atomic_store_n(&(recorder.active), 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&(recorder.lock));
+    return 1;
+}
+
+/* Stops the active recording, if any, and closes its file. */
+void cbTraceStop(void) {
+    pthread_mutex_lock(&(recorder.lock));
+    if (recorder.active) {
+        __atomic_store_n(&(recorder.active), 0, __ATOMIC_RELEASE);
+        _traceFlush();
+        fclose(recorder.file);
+        recorder.file = NULL;
+    }
+    pthread_mutex_unlock(&(recorder.lock));
+}
+
+/* Logs an operation, if a recording is active and covers the buffer.
+ * Called by the library itself when compiled with CB_TRACE.
+ */
+void cbTraceRecord(CBTraceOp op, CircBuffer *cBuff, ulong size, int upTo) {
+    // Filter operations out before taking the lock.
+    if (!__atomic_load_n(&(recorder.active), __ATOMIC_ACQUIRE)) return;
+    CircBuffer *onlyBuff = __atomic_load_n(&(recorder.onlyBuff),
+                                           __ATOMIC_RELAXED);
+    if ((onlyBuff != NULL) && (onlyBuff != cBuff)) return;
+    if (threadId == 0)
+        threadId = __atomic_fetch_add(&nextThreadId, 1, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&(recorder.lock));
+    if (recorder.active &&
+        ((recorder.onlyBuff == NULL) || (recorder.onlyBuff == cBuff))) {
+        // Timestamps are taken with the lock held, so that records are
+        // stored in chronological order.
+        uint64_t now = _traceNow();
+        CBTraceRecord *rec = recorder.block + recorder.blockCount;
+        rec->timestamp = now > recorder.startNs ? now - recorder.startNs : 0;
+        rec->size = size > UINT32_MAX ? UINT32_MAX : (uint32_t)size;
+        rec->thread = threadId;
+        rec->op = (uint8_t)op;
+        rec->flags = upTo ? CB_TRACE_UPTO : 0;
+        if (++(recorder.blockCount) == TRACE_BLOCK) _traceFlush();
+    }
+    pthread_mutex_unlock(&(recorder.lock));
+}
+
+/* Loads all the records in a trace file in a newly allocated array, storing
+ * their number in "count". The array must be freed by the caller.
+ * Returns the array, or NULL on failure or if the trace is empty.
+ */
+CBTraceRecord *cbTraceLoad(const char *path, ulong *count) {
+    if ((path == NULL) || (count == NULL)) return NULL;  // Sanity checks.
+    *count = 0;
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    CBTraceHeader header;
+    if ((fread(&header, sizeof(header), 1, file) != 1) ||
+        (memcmp(header.magic, CB_TRACE_MAGIC, sizeof(header.magic)) != 0) ||
+        (header.recordSize != sizeof(CBTraceRecord))) {
+        // Not a trace, or recorded by an incompatible version.
+        fclose(file);
+        return NULL;
+    }
+    // The number of records follows from the file size.
+    long start = ftell(file);
+    fseek(file, 0, SEEK_END);
+    long end = ftell(file);
+    fseek(file, start, SEEK_SET);
+    ulong records = (ulong)(end - start) / sizeof(CBTraceRecord);
+    if (records == 0) {
+        fclose(file);
+        return NULL;
+    }
+    CBTraceRecord *trace = malloc(records * sizeof(CBTraceRecord));
+    if (trace == NULL) {
+        fclose(file);
+        return NULL;
+    }
+    *count = fread(trace, sizeof(CBTraceRecord), records, file);
+    fclose(file);
+    return trace;
+}
@@ -0,0 +1,63 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the optional
+ * Circular Buffer operation recorder.
+ * When the library is compiled with CB_TRACE defined, every call to cbWrite,
+ * cbRead, cbCopy and cbPaste is logged, while a recording is active, as a
+ * compact fixed-size binary record: operation, requested size, timestamp and
+ * calling thread. Recordings can be limited to a single buffer.
+ * Records are collected in memory and flushed to the trace file in blocks.
+ * A trace file starts with a header holding a magic string and the record
+ * size, followed by the records in the order they were logged; records are
+ * stored in host byte order.
+ * Without CB_TRACE the hooks compile to nothing, so this costs nothing.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef CIRCBUFTRACE_H
+#define CIRCBUFTRACE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "CircularBuffer.h"
+
+#define CB_TRACE_MAGIC "CBTRACE1"
+
+/* Operations that can be logged. */
+typedef enum {
+    CB_OP_WRITE = 0,
+    CB_OP_READ,
+    CB_OP_COPY,
+    CB_OP_PASTE
+} CBTraceOp;
+
+// Record flags.
+#define CB_TRACE_UPTO 0x1
+
+/* A trace record: 16 bytes. */
+typedef struct {
+    uint64_t timestamp;     // Nanoseconds since the recording started.
+    uint32_t size;          // Entries requested (1 for reads and writes).
+    uint16_t thread;        // Small sequential id of the calling thread.
+    uint8_t op;             // A CBTraceOp.
+    uint8_t flags;          // CB_TRACE_* flags.
+} CBTraceRecord;
+
+/* Trace file header. */
+typedef struct {
+    char magic[8];
+    uint32_t recordSize;
+    uint32_t reserved;
+} CBTraceHeader;
+
+int cbTraceStart(const char *path, CircBuffer *onlyBuff);
+void cbTraceStop(void);
+void cbTraceRecord(CBTraceOp op, CircBuffer *cBuff, ulong size, int upTo);
+CBTraceRecord *cbTraceLoad(const char *path, ulong *count);
+
+#endif
@@ -0,0 +1,185 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains a type-safe front end for Circular Buffers, based on
+ * C11 generic selections.
+ * Plain buffers hold "void *" entries, so numbers must be cast (or boxed)
+ * to be stored, and a mistake in their width goes unnoticed. Here, buffers
+ * of each integer and floating type store their values packed, in arrays
+ * of that very type, with inline routines generated by a macro; the
+ * cbtWrite, cbtRead, cbtCopy, cbtPaste and cbtDelete macros then select
+ * the right routine from the type of the buffer, at compile time. Plain
+ * buffers are selected too, for pointer entries.
+ * Reads store the value through a pointer, since no value is left to tell
+ * that the buffer is empty, and return 1 on success, 0 otherwise. Values
+ * are thus read, copied and pasted through pointers to the element type,
+ * which the compiler checks; writes may be checked with -Wconversion.
+ * Semantics are the same as the plain routines. Buffers for other types,
+ * e.g. small structures, can be generated with CB_TYPED_DEFINE, and used
+ * through their own routines.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef CIRCBUFTYPED_H
+#define CIRCBUFTYPED_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "CircularBuffer.h"
+
+/* Generates a buffer type named CircBuffer<Suffix> that stores values of
+ * the given type, with its routines: createCBuffer<Suffix>,
+ * deleteCBuffer<Suffix>, cbWrite<Suffix>, cbRead<Suffix>, cbCopy<Suffix>
+ * and cbPaste<Suffix>.
+ * Buffers are made of a data area, its length, the positions of the
+ * oldest entry and of the next free cell, and a counter of the entries.
+ */
+#define CB_TYPED_DEFINE(Suffix, Type)                                        \
+typedef struct {                                                             \
+    Type *_data;                                                             \
+    ulong cbSize;                                                            \
+    ulong _readIdx;                                                          \
+    ulong _writeIdx;                                                         \
+    ulong dataCount;                                                         \
+} CircBuffer##Suffix;                                                        \
+                                                                             \
+static inline CircBuffer##Suffix *createCBuffer##Suffix(ulong cbSize) {      \
+    if (cbSize == 0) return NULL;                                            \
+    CircBuffer##Suffix *cBuff = calloc(1, sizeof(CircBuffer##Suffix));       \
+    if (cBuff == NULL) return NULL;                                          \
+    cBuff->_data = calloc(cbSize, sizeof(Type));                             \
+    if (cBuff->_data == NULL) {                                              \
+        free(cBuff);                                                         \
+        return NULL;                                                         \
+    }                                                                        \
+    cBuff->cbSize = cbSize;                                                  \
+    return cBuff;                                                            \
+}                                                                            \
+                                                                             \
+static inline void deleteCBuffer##Suffix(CircBuffer##Suffix *cBuff) {        \
+    if (cBuff == NULL) return;                                               \
+    free(cBuff->_data);                                                      \
+    free(cBuff);                                                             \
+}                                                                            \
+                                                                             \
+static inline int cbWrite##Suffix(CircBuffer##Suffix *cBuff, Type data) {    \
+    if ((cBuff == NULL) || (cBuff->dataCount == cBuff->cbSize)) return 0;    \
+    cBuff->_data[cBuff->_writeIdx] = data;                                   \
+    if (++cBuff->_writeIdx == cBuff->cbSize) cBuff->_writeIdx = 0;           \
+    cBuff->dataCount++;                                                      \
+    return 1;                                                                \
+}                                                                            \
+                                                                             \
+static inline int cbRead##Suffix(CircBuffer##Suffix *cBuff, Type *data) {    \
+    if ((cBuff == NULL) || (data == NULL) || (cBuff->dataCount == 0))        \
+        return 0;                                                            \
+    *data = cBuff->_data[cBuff->_readIdx];                                   \
+    if (++cBuff->_readIdx == cBuff->cbSize) cBuff->_readIdx = 0;             \
+    cBuff->dataCount--;                                                      \
+    return 1;                                                                \
+}                                                                            \
+                                                                             \
+static inline ulong cbCopy##Suffix(CircBuffer##Suffix *cBuff, Type *dataBuf, \
+                                   ulong bufSize, int upTo) {                \
+    if ((cBuff == NULL) || (dataBuf == NULL) || (bufSize == 0)) return 0;    \
+    ulong ops = bufSize;                                                     \
+    if (cBuff->dataCount < bufSize) {                                        \
+        if (!upTo) return 0;                                                 \
+        ops = cBuff->dataCount;                                              \
+    }                                                                        \
+    ulong toEnd = cBuff->cbSize - cBuff->_readIdx;                           \
+    ulong first = ops < toEnd ? ops : toEnd;                                 \
+    memcpy(dataBuf, cBuff->_data + cBuff->_readIdx, first * sizeof(Type));   \
+    memcpy(dataBuf + first, cBuff->_data, (ops - first) * sizeof(Type));     \
+    cBuff->_readIdx = ops < toEnd ? cBuff->_readIdx + ops : ops - toEnd;     \
+    cBuff->dataCount -= ops;                                                 \
+    return ops;                                                              \
+}                                                                            \
+                                                                             \
+static inline ulong cbPaste##Suffix(CircBuffer##Suffix *cBuff,               \
+                                    const Type *dataBuf, ulong bufSize,      \
+                                    int upTo) {                              \
+    if ((cBuff == NULL) || (dataBuf == NULL) || (bufSize == 0)) return 0;    \
+    ulong freeCells = cBuff->cbSize - cBuff->dataCount;                      \
+    ulong ops = bufSize;                                                     \
+    if (freeCells < bufSize) {                                               \
+        if (!upTo) return 0;                                                 \
+        ops = freeCells;                                                     \
+    }                                                                        \
+    ulong toEnd = cBuff->cbSize - cBuff->_writeIdx;                          \
+    ulong first = ops < toEnd ? ops : toEnd;                                 \
+    memcpy(cBuff->_data + cBuff->_writeIdx, dataBuf, first * sizeof(Type));  \
+    memcpy(cBuff->_data, dataBuf + first, (ops - first) * sizeof(Type));     \
+    cBuff->_writeIdx = ops < toEnd ? cBuff->_writeIdx + ops : ops - toEnd;   \
+    cBuff->dataCount += ops;                                                 \
+    return ops;                                                              \
+}
+
+// Buffers of all the fixed-width integer and floating types.
+CB_TYPED_DEFINE(I8, int8_t)
+CB_TYPED_DEFINE(U8, uint8_t)
+CB_TYPED_DEFINE(I16, int16_t)
+CB_TYPED_DEFINE(U16, uint16_t)
+CB_TYPED_DEFINE(I32, int32_t)
+CB_TYPED_DEFINE(U32, uint32_t)
+CB_TYPED_DEFINE(I64, int64_t)
+CB_TYPED_DEFINE(U64, uint64_t)
+CB_TYPED_DEFINE(F32, float)
+CB_TYPED_DEFINE(F64, double)
+
+/* Plain buffers, with the same signatures as the generated routines. */
+static inline void deleteCBufferPtr(CircBuffer *cBuff) {
+    deleteCBuffer(cBuff, 0);
+}
+
+static inline int cbWritePtr(CircBuffer *cBuff, void *data) {
+    return cbWrite(cBuff, data);
+}
+
+static inline int cbReadPtr(CircBuffer *cBuff, void **data) {
+    if ((cBuff == NULL) || (data == NULL) || (cBuff->dataCount == 0))
+        return 0;
+    *data = cbRead(cBuff);
+    return 1;
+}
+
+static inline ulong cbCopyPtr(CircBuffer *cBuff, void **dataBuf,
+                              ulong bufSize, int upTo) {
+    return cbCopy(cBuff, dataBuf, bufSize, upTo);
+}
+
+static inline ulong cbPastePtr(CircBuffer *cBuff, void **dataBuf,
+                               ulong bufSize, int upTo) {
+    return cbPaste(cBuff, dataBuf, bufSize, upTo);
+}
+
+/* Selects a routine from the type of a buffer. */
+#define _CBT_SELECT(cBuff, op) _Generic((cBuff), \
+    CircBufferI8 *: op##I8,                      \
+    CircBufferU8 *: op##U8,                      \
+    CircBufferI16 *: op##I16,                    \
+    CircBufferU16 *: op##U16,                    \
+    CircBufferI32 *: op##I32,                    \
+    CircBufferU32 *: op##U32,                    \
+    CircBufferI64 *: op##I64,                    \
+    CircBufferU64 *: op##U64,                    \
+    CircBufferF32 *: op##F32,                    \
+    CircBufferF64 *: op##F64,                    \
+    CircBuffer *: op##Ptr)
+
+// Type-generic routines.
+#define cbtDelete(cBuff) _CBT_SELECT(cBuff, deleteCBuffer)(cBuff)
+#define cbtWrite(cBuff, data) _CBT_SELECT(cBuff, cbWrite)(cBuff, data)
+#define cbtRead(cBuff, data) _CBT_SELECT(cBuff, cbRead)(cBuff, data)
+#define cbtCopy(cBuff, dataBuf, bufSize, upTo) \
+    _CBT_SELECT(cBuff, cbCopy)(cBuff, dataBuf, bufSize, upTo)
+#define cbtPaste(cBuff, dataBuf, bufSize, upTo) \
+    _CBT_SELECT(cBuff, cbPaste)(cBuff, dataBuf, bufSize, upTo)
+
+#endif
@@ -0,0 +1,128 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage the Delay Line data structure.
+ * See the header file for a general description of the structure.
+ * See each function's comments for a description of their behaviour.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "DelayLine.h"
+
+/* Finds where a tap starts reading for the last "n" samples written: the
+ * returned run holds n + 1 samples, and its i-th output sample is the
+ * interpolation of the i-th and (i+1)-th ones with weights "frac" and
+ * 1 - frac respectively.
+ * Returns NULL if the arguments are out of the line's limits.
+ */
+static inline const float *_dlTapStart(DelayLine *dLine, float delay,
+                                       ulong n, float *frac) {
+    if ((n == 0) || (n > dLine->maxBlock) || !(delay >= 0.0f) ||
+        (delay > (float)dLine->maxDelay)) return NULL;
+    ulong whole = (ulong)delay;
+    *frac = delay - (float)whole;
+    ulong start = (dLine->_writePos - n - whole - 1) & dLine->_mask;
+    return dLine->_data + start;
+}
+
+/* Creates a new Delay Line for delays of up to "maxDelay" samples, written
+ * and read in blocks of up to "maxBlock" samples. Samples start at zero.
+ */
+DelayLine *createDelayLine(ulong maxDelay, ulong maxBlock) {
+    // Sanity checks.
+    if ((maxBlock == 0) || (maxDelay > (1UL << 40)) ||
+        (maxBlock > (1UL << 40))) return NULL;
+    // Keep enough samples for a block and the longest delay after it.
+    ulong size = 1;
+    while (size < maxDelay + maxBlock + 1) size <<= 1;
+    // Allocate memory for the new structure and its data area.
+    DelayLine *dLine = calloc(1, sizeof(DelayLine));
+    if (dLine == NULL) return NULL;  // calloc failed.
+    dLine->_guard = maxBlock + 1;
+    dLine->_data = calloc(size + dLine->_guard, sizeof(float));
+    if (dLine->_data == NULL) {
+        // calloc failed.
+        free(dLine);
+        return NULL;
+    }
+    // Set up the new structure.
+    dLine->_mask = size - 1;
+    dLine->_writePos = 0;
+    dLine->maxDelay = maxDelay;
+    dLine->maxBlock = maxBlock;
+    return dLine;
+}
+
+/* Deletes a Delay Line. */
+void deleteDelayLine(DelayLine *dLine) {
+    if (dLine == NULL) return;
+    free(dLine->_data);
+    free(dLine);
+}
+
+/* Writes a block of samples into the line.
+ * Returns the number of samples written: all of them, or none if the block
+ * is larger than the maximum.
+ */
+ulong dlWrite(DelayLine *dLine, const float *in, ulong n) {
+    // Sanity checks.
+    if ((dLine == NULL) || (in == NULL) || (n == 0) || (n > dLine->maxBlock))
+        return 0;
+    ulong size = dLine->_mask + 1;
+    ulong pos = dLine->_writePos & dLine->_mask;
+    ulong toEnd = size - pos;
+    if (toEnd < n) {
+        // Two separate writes, wrapping around the line.
+        memcpy(dLine->_data + pos, in, toEnd * sizeof(float));
+        memcpy(dLine->_data, in + toEnd, (n - toEnd) * sizeof(float));
+        // Update the mirror of the start.
+        memcpy(dLine->_data + size, dLine->_data,
+               (n - toEnd) * sizeof(float));
+    } else {
+        memcpy(dLine->_data + pos, in, n * sizeof(float));
+        if (pos < dLine->_guard) {
+            // Update the mirror of the start.
+            ulong mirrored = dLine->_guard - pos;
+            if (mirrored > n) mirrored = n;
+            memcpy(dLine->_data + size + pos, in, mirrored * sizeof(float));
+        }
+    }
+    dLine->_writePos += n;
+    return n;
+}
+
+/* Reads the last "n" samples written, delayed by the given (possibly
+ * fractional) number of samples, into the provided array.
+ * Returns 1 on success, 0 if the arguments exceed the line's limits.
+ */
+int dlTap(DelayLine *dLine, float delay, float *out, ulong n) {
+    if ((dLine == NULL) || (out == NULL)) return 0;  // Sanity check.
+    float frac;
+    const float *src = _dlTapStart(dLine, delay, n, &frac);
+    if (src == NULL) return 0;
+    float nearWeight = 1.0f - frac;
+    for (ulong i = 0; i < n; i++)
+        out[i] = frac * src[i] + nearWeight * src[i + 1];
+    return 1;
+}
+
+/* Like dlTap, but scales the delayed samples by the given gain and adds
+ * them to the ones in the provided array, so that many taps can be mixed.
+ */
+int dlTapMix(DelayLine *dLine, float delay, float gain, float *out, ulong n) {
+    if ((dLine == NULL) || (out == NULL)) return 0;  // Sanity check.
+    float frac;
+    const float *src = _dlTapStart(dLine, delay, n, &frac);
+    if (src == NULL) return 0;
+    float farGain = gain * frac;
+    float nearGain = gain * (1.0f - frac);
+    for (ulong i = 0; i < n; i++)
+        out[i] += farGain * src[i] + nearGain * src[i + 1];
+    return 1;
+}
@@ -0,0 +1,47 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the Delay Line
+ * data structure. See the source file for a brief description of what each
+ * function does.
+ * A delay line is a circular buffer of float samples, written one block at
+ * a time, from which any number of taps read the same samples back at given
+ * delays from the write position. Delays can be fractional, in which case
+ * samples are linearly interpolated.
+ * The first samples of the data area are mirrored right after its end, for
+ * as many as a block holds: a tap over a whole block then always reads a
+ * contiguous run of memory, wherever it starts, and its loop carries no wrap
+ * checks, so that the compiler can vectorize it.
+ * Blocks are limited to a maximum size, given at creation together with the
+ * maximum delay, which tells how many samples must be kept.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef DELAYLINE_H
+#define DELAYLINE_H
+
+#include <sys/types.h>
+
+/* A delay line is made of its data area, followed by the mirror of its
+ * start, the size mask, the write position, and the limits it was created
+ * with.
+ */
+typedef struct {
+    float *_data;
+    ulong _mask;
+    ulong _writePos;
+    ulong _guard;
+    ulong maxDelay;
+    ulong maxBlock;
+} DelayLine;
+
+DelayLine *createDelayLine(ulong maxDelay, ulong maxBlock);
+void deleteDelayLine(DelayLine *dLine);
+ulong dlWrite(DelayLine *dLine, const float *in, ulong n);
+int dlTap(DelayLine *dLine, float delay, float *out, ulong n);
+int dlTapMix(DelayLine *dLine, float delay, float gain, float *out, ulong n);
+
+#endif
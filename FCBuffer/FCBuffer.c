@@ -0,0 +1,180 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage the Flat Combining Buffer.
+ * See the header file for a general description of the structure.
+ * See each function's comments for a description of their behaviour.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "FCBuffer.h"
+
+/* Relaxes the CPU while spinning. */
+static inline void _fcRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/* Tells whether a slot has been handed out by a buffer. */
+static inline int _fcValidSlot(FCBuffer *fcBuff, int slot) {
+    return (fcBuff != NULL) && (slot >= 0) &&
+           (slot < __atomic_load_n(&(fcBuff->_nSlots), __ATOMIC_RELAXED));
+}
+
+/* Serves all the pending requests. Must hold the combiner lock. */
+static void _fcCombine(FCBuffer *fcBuff) {
+    int nSlots = __atomic_load_n(&(fcBuff->_nSlots), __ATOMIC_ACQUIRE);
+    for (int i = 0; i < nSlots; i++) {
+        FCSlot *slot = fcBuff->_slots + i;
+        int request = __atomic_load_n(&(slot->_request), __ATOMIC_ACQUIRE);
+        switch (request) {
+            case FC_WRITE:
+                slot->_result = (ulong)cbWrite(fcBuff->_ring, slot->_data);
+                break;
+            case FC_READ:
+                slot->_data = cbRead(fcBuff->_ring);
+                break;
+            case FC_COPY:
+                slot->_result = cbCopy(fcBuff->_ring, slot->_dataBuf,
+                                       slot->_bufSize, slot->_upTo);
+                break;
+            case FC_PASTE:
+                slot->_result = cbPaste(fcBuff->_ring, slot->_dataBuf,
+                                        slot->_bufSize, slot->_upTo);
+                break;
+            default:
+                continue;  // Nothing to do.
+        }
+        __atomic_store_n(&(slot->_request), FC_NONE, __ATOMIC_RELEASE);
+    }
+}
+
+/* Publishes a request and waits until it's been served, combining if the
+ * lock is free.
+ */
+static void _fcExecute(FCBuffer *fcBuff, FCSlot *slot, int request) {
+    __atomic_store_n(&(slot->_request), request, __ATOMIC_RELEASE);
+    for (;;) {
+        if (!__atomic_load_n(&(fcBuff->_lock), __ATOMIC_RELAXED) &&
+            !__atomic_exchange_n(&(fcBuff->_lock), 1, __ATOMIC_ACQUIRE)) {
+            // We're the combiner: serve everyone, ourselves included.
+            _fcCombine(fcBuff);
+            __atomic_store_n(&(fcBuff->_lock), 0, __ATOMIC_RELEASE);
+        }
+        if (__atomic_load_n(&(slot->_request), __ATOMIC_ACQUIRE) == FC_NONE)
+            return;
+        _fcRelax();
+    }
+}
+
+/* Creates a new Flat Combining Buffer of the specified size, usable by up
+ * to the given number of threads.
+ */
+FCBuffer *createFCBuffer(ulong cbSize, int maxThreads) {
+    // Sanity checks.
+    if ((cbSize == 0) || (maxThreads <= 0)) return NULL;
+    // Allocate memory for the new structure, its slots and its buffer.
+    FCBuffer *fcBuff = aligned_alloc(FC_CACHE_LINE, sizeof(FCBuffer));
+    if (fcBuff == NULL) return NULL;  // aligned_alloc failed.
+    memset(fcBuff, 0, sizeof(FCBuffer));
+    fcBuff->_slots = aligned_alloc(FC_CACHE_LINE,
+                                   (ulong)maxThreads * sizeof(FCSlot));
+    if (fcBuff->_slots == NULL) {
+        // aligned_alloc failed.
+        free(fcBuff);
+        return NULL;
+    }
+    memset(fcBuff->_slots, 0, (ulong)maxThreads * sizeof(FCSlot));
+    fcBuff->_ring = createCBuffer(cbSize);
+    if (fcBuff->_ring == NULL) {
+        // createCBuffer failed.
+        free(fcBuff->_slots);
+        free(fcBuff);
+        return NULL;
+    }
+    fcBuff->_maxSlots = maxThreads;
+    return fcBuff;
+}
+
+/* Deletes a Flat Combining Buffer. No thread may be using it. */
+void deleteFCBuffer(FCBuffer *fcBuff, int toFree) {
+    if (fcBuff == NULL) return;
+    deleteCBuffer(fcBuff->_ring, toFree);
+    free(fcBuff->_slots);
+    free(fcBuff);
+}
+
+/* Registers the calling thread with a buffer.
+ * Returns the slot to use in all subsequent calls, or -1 if there are no
+ * slots left.
+ */
+int fcRegister(FCBuffer *fcBuff) {
+    if (fcBuff == NULL) return -1;  // Sanity check.
+    int slot = __atomic_load_n(&(fcBuff->_nSlots), __ATOMIC_RELAXED);
+    do {
+        if (slot >= fcBuff->_maxSlots) return -1;  // No slots left.
+    } while (!__atomic_compare_exchange_n(&(fcBuff->_nSlots), &slot,
+                                          slot + 1, 0, __ATOMIC_ACQ_REL,
+                                          __ATOMIC_RELAXED));
+    return slot;
+}
+
+/* Reads an entry from the given buffer. Also makes such entry unavailable.
+ * Returns the entry or NULL.
+ */
+void *fcRead(FCBuffer *fcBuff, int slot) {
+    // Sanity check.
+    if (!_fcValidSlot(fcBuff, slot)) return NULL;
+    FCSlot *req = fcBuff->_slots + slot;
+    _fcExecute(fcBuff, req, FC_READ);
+    return req->_data;
+}
+
+/* Writes an entry in the given buffer.
+ * Returns 1 on success, 0 if the buffer was full.
+ */
+int fcWrite(FCBuffer *fcBuff, int slot, void *data) {
+    // Sanity checks.
+    if (!_fcValidSlot(fcBuff, slot) || (data == NULL)) return 0;
+    FCSlot *req = fcBuff->_slots + slot;
+    req->_data = data;
+    _fcExecute(fcBuff, req, FC_WRITE);
+    return (int)req->_result;
+}
+
+/* Reads a portion of the buffer, placing it in the provided area.
+ * Behaves like cbCopy.
+ */
+ulong fcCopy(FCBuffer *fcBuff, int slot, void **dataBuf, ulong bufSize,
+             int upTo) {
+    // Sanity check.
+    if (!_fcValidSlot(fcBuff, slot)) return 0;
+    FCSlot *req = fcBuff->_slots + slot;
+    req->_dataBuf = dataBuf;
+    req->_bufSize = bufSize;
+    req->_upTo = upTo;
+    _fcExecute(fcBuff, req, FC_COPY);
+    return req->_result;
+}
+
+/* Writes a block of data into the buffer.
+ * Behaves like cbPaste.
+ */
+ulong fcPaste(FCBuffer *fcBuff, int slot, void **dataBuf, ulong bufSize,
+              int upTo) {
+    // Sanity check.
+    if (!_fcValidSlot(fcBuff, slot)) return 0;
+    FCSlot *req = fcBuff->_slots + slot;
+    req->_dataBuf = dataBuf;
+    req->_bufSize = bufSize;
+    req->_upTo = upTo;
+    _fcExecute(fcBuff, req, FC_PASTE);
+    return req->_result;
+}
@@ -0,0 +1,76 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the Flat
+ * Combining Buffer, a thread-safe Circular Buffer meant for heavily
+ * contended workloads. See the source file for a brief description of what
+ * each function does.
+ * Each thread that uses the buffer registers once, getting a private request
+ * slot. To operate, a thread publishes its request in its slot and then
+ * tries to become the combiner by taking a single lock: the combiner scans
+ * all the slots and executes every pending request, in a batch, on a plain
+ * Circular Buffer, then releases the lock. Threads that don't get the lock
+ * just wait for their own slot to be served.
+ * This way the buffer's metadata stays in the combiner's cache for a whole
+ * batch, instead of bouncing between cores at every operation, and each
+ * waiting thread only spins on its own cache line.
+ * Operations have the same semantics as the Circular Buffer ones.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef FCBUFFER_H
+#define FCBUFFER_H
+
+#include <sys/types.h>
+
+#include "../CircularBuffer/CircularBuffer.h"
+
+#define FC_CACHE_LINE 64
+
+/* Request codes. */
+typedef enum {
+    FC_NONE = 0,    // No pending request.
+    FC_WRITE,
+    FC_READ,
+    FC_COPY,
+    FC_PASTE
+} FCRequest;
+
+/* A request slot, on a cache line of its own: the request code and its
+ * arguments are written by the owner thread, the result by the combiner,
+ * which then clears the code to signal completion.
+ */
+typedef struct {
+    int _request;
+    int _upTo;
+    void *_data;
+    void **_dataBuf;
+    ulong _bufSize;
+    ulong _result;
+} __attribute__((aligned(FC_CACHE_LINE))) FCSlot;
+
+/* A flat combining buffer is made of the underlying Circular Buffer, the
+ * request slots, the number of slots handed out and the combiner lock.
+ */
+typedef struct {
+    CircBuffer *_ring;
+    FCSlot *_slots;
+    int _maxSlots;
+    int _nSlots;
+    int _lock __attribute__((aligned(FC_CACHE_LINE)));
+} FCBuffer;
+
+FCBuffer *createFCBuffer(ulong cbSize, int maxThreads);
+void deleteFCBuffer(FCBuffer *fcBuff, int toFree);
+int fcRegister(FCBuffer *fcBuff);
+void *fcRead(FCBuffer *fcBuff, int slot);
+int fcWrite(FCBuffer *fcBuff, int slot, void *data);
+ulong fcCopy(FCBuffer *fcBuff, int slot, void **dataBuf, ulong bufSize,
+             int upTo);
+ulong fcPaste(FCBuffer *fcBuff, int slot, void **dataBuf, ulong bufSize,
+              int upTo);
+
+#endif
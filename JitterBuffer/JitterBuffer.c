@@ -0,0 +1,165 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage the Jitter Buffer data structure.
+ * See the header file for a general description of the structure.
+ * See each function's comments for a description of their behaviour.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+
+#include "JitterBuffer.h"
+
+/* Drops all the packets held, handing them back to the caller. */
+static void _jbFlush(JitterBuffer *jBuff) {
+    for (ulong i = 0; (i <= jBuff->_mask) && (jBuff->count != 0); i++) {
+        if (jBuff->_slots[i] == NULL) continue;
+        if (jBuff->_onDiscard != NULL)
+            jBuff->_onDiscard(jBuff->_ctx, jBuff->_slots[i]);
+        jBuff->_slots[i] = NULL;
+        jBuff->count--;
+    }
+}
+
+/* Starts the stream over from a packet: playing resumes from it, and the
+ * transit time and jitter estimates are seeded with it alone.
+ */
+static void _jbRestart(JitterBuffer *jBuff, JBPacket *pkt,
+                       uint64_t arrival) {
+    int64_t transit = (int64_t)(arrival - pkt->timestamp);
+    jBuff->_started = 1;
+    jBuff->_playSeq = pkt->seq;
+    jBuff->_playTs = pkt->timestamp;
+    jBuff->_baseTransit = transit;
+    jBuff->_lastTransit = transit;
+    jBuff->jitter = 0.0;
+    jBuff->targetDelay = jBuff->_minDelay;
+}
+
+/* Updates the transit time and jitter estimates with a new packet, in
+ * arrival order, then the target delay (see RFC 3550, A.8).
+ */
+static void _jbEstimate(JitterBuffer *jBuff, JBPacket *pkt,
+                        uint64_t arrival) {
+    int64_t transit = (int64_t)(arrival - pkt->timestamp);
+    int64_t d = transit - jBuff->_lastTransit;
+    if (d < 0) d = -d;
+    jBuff->jitter += ((double)d - jBuff->jitter) / 16.0;
+    if (transit < jBuff->_baseTransit) jBuff->_baseTransit = transit;
+    jBuff->_lastTransit = transit;
+    double target = JB_JITTER_FACTOR * jBuff->jitter;
+    if (target < (double)jBuff->_minDelay) target = (double)jBuff->_minDelay;
+    if (target > (double)jBuff->_maxDelay) target = (double)jBuff->_maxDelay;
+    jBuff->targetDelay = (uint64_t)target;
+}
+
+/* Creates a new Jitter Buffer that holds packets up to "capacity" sequence
+ * numbers ahead of the next one to play (rounded up to a power of two).
+ * Timestamps grow by "frameTicks" per packet, and the target delay is kept
+ * between "minDelay" and "maxDelay". Hooks may be NULL.
+ */
+JitterBuffer *createJitterBuffer(ulong capacity, uint64_t frameTicks,
+                                 uint64_t minDelay, uint64_t maxDelay,
+                                 JBConcealFn onConceal, JBDiscardFn onDiscard,
+                                 void *ctx) {
+    // Sanity checks.
+    if ((capacity == 0) || (capacity > (1UL << 31)) || (frameTicks == 0) ||
+        (minDelay > maxDelay) || (maxDelay > ((uint64_t)INT64_MAX >> 1)))
+        return NULL;
+    ulong size = 1;
+    while (size < capacity) size <<= 1;
+    // Allocate memory for the new structure and its slots.
+    JitterBuffer *jBuff = calloc(1, sizeof(JitterBuffer));
+    if (jBuff == NULL) return NULL;  // calloc failed.
+    jBuff->_slots = calloc(size, sizeof(JBPacket *));
+    if (jBuff->_slots == NULL) {
+        // calloc failed.
+        free(jBuff);
+        return NULL;
+    }
+    // Set up the new structure.
+    jBuff->_mask = size - 1;
+    jBuff->_frameTicks = frameTicks;
+    jBuff->targetDelay = minDelay;
+    jBuff->_minDelay = minDelay;
+    jBuff->_maxDelay = maxDelay;
+    jBuff->_onConceal = onConceal;
+    jBuff->_onDiscard = onDiscard;
+    jBuff->_ctx = ctx;
+    return jBuff;
+}
+
+/* Deletes a Jitter Buffer, handing back the packets it still holds. */
+void deleteJitterBuffer(JitterBuffer *jBuff) {
+    if (jBuff == NULL) return;
+    _jbFlush(jBuff);
+    free(jBuff->_slots);
+    free(jBuff);
+}
+
+/* Stores a packet that came in at the given time.
+ * A packet too far ahead of the next one to play means that the stream
+ * jumped: the buffer is then flushed, and playing and the estimates restart
+ * from it, as from the first packet.
+ * Returns 1 on success, 0 if the packet was late or a duplicate (it
+ * remains the caller's).
+ */
+int jbPush(JitterBuffer *jBuff, JBPacket *pkt, uint64_t arrival) {
+    if ((jBuff == NULL) || (pkt == NULL)) return 0;  // Sanity check.
+    int32_t ahead = (int32_t)(pkt->seq - jBuff->_playSeq);
+    if (!jBuff->_started) {
+        // The first packet starts the stream.
+        _jbRestart(jBuff, pkt, arrival);
+    } else if ((ahead >= 0) && ((ulong)ahead > jBuff->_mask)) {
+        // Too far ahead: resync, without the old stream's estimates.
+        _jbFlush(jBuff);
+        _jbRestart(jBuff, pkt, arrival);
+        jBuff->resyncs++;
+    } else {
+        _jbEstimate(jBuff, pkt, arrival);
+        if (ahead < 0) {
+            // Its turn has passed already.
+            jBuff->late++;
+            return 0;
+        }
+    }
+    JBPacket **slot = jBuff->_slots + (pkt->seq & jBuff->_mask);
+    if (*slot != NULL) {
+        jBuff->duplicates++;
+        return 0;
+    }
+    *slot = pkt;
+    jBuff->count++;
+    return 1;
+}
+
+/* Plays the next packet, if its time has come, since the buffer is meant to
+ * be polled at the stream's pace. If the packet was lost, returns what the
+ * concealment hook provides instead, and moves on.
+ * Returns the packet, which becomes the caller's, or NULL.
+ */
+JBPacket *jbPop(JitterBuffer *jBuff, uint64_t now) {
+    // Sanity check.
+    if ((jBuff == NULL) || !jBuff->_started) return NULL;
+    JBPacket **slot = jBuff->_slots + (jBuff->_playSeq & jBuff->_mask);
+    JBPacket *pkt = *slot;
+    uint64_t timestamp = pkt != NULL ? pkt->timestamp : jBuff->_playTs;
+    int64_t due = (int64_t)timestamp + jBuff->_baseTransit +
+                  (int64_t)jBuff->targetDelay;
+    if ((int64_t)now < due) return NULL;  // Not yet.
+    uint32_t seq = jBuff->_playSeq++;
+    jBuff->_playTs = timestamp + jBuff->_frameTicks;
+    if (pkt != NULL) {
+        *slot = NULL;
+        jBuff->count--;
+        return pkt;
+    }
+    // Lost packet.
+    jBuff->concealed++;
+    if (jBuff->_onConceal == NULL) return NULL;
+    return jBuff->_onConceal(jBuff->_ctx, seq, timestamp);
+}
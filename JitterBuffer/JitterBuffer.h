@@ -0,0 +1,90 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the Jitter
+ * Buffer data structure. See the source file for a brief description of
+ * what each function does.
+ * A jitter buffer absorbs the variable delay of a network: packets come in
+ * out of order and at uneven times, and are played out in sequence and at
+ * a steady pace, each one a fixed delay after it was sent.
+ * Packets are held in a circular array indexed by their sequence number, so
+ * that storing a packet and taking the next one to play are O(1), however
+ * they come in. Packets start with a JBPacket header, which holds their
+ * sequence number and media timestamp.
+ * The delay is adaptive: the inter-arrival jitter is estimated as in RFC
+ * 3550, and the target delay is kept at a multiple of it, within the given
+ * bounds, on top of the shortest transit time seen. A packet is played once
+ * its timestamp plus that delay has passed; packets that come in after
+ * their turn are discarded. When the turn of a lost packet comes, a
+ * concealment hook may provide a replacement.
+ * Timestamps, arrival times and delays are all in the same unit (e.g. the
+ * media clock), and timestamps must grow by a fixed amount per packet.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef JITTERBUFFER_H
+#define JITTERBUFFER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+// Target delay, in units of the estimated jitter.
+#define JB_JITTER_FACTOR 4.0
+
+/* Header that packets must start with. */
+typedef struct {
+    uint64_t timestamp;
+    uint32_t seq;
+} JBPacket;
+
+/* Called when the turn of a lost packet comes, with its sequence number and
+ * expected timestamp. May return a replacement packet, or NULL.
+ */
+typedef JBPacket *(*JBConcealFn)(void *ctx, uint32_t seq, uint64_t timestamp);
+
+/* Called for packets held in the buffer that are dropped without being
+ * played, e.g. upon deletion.
+ */
+typedef void (*JBDiscardFn)(void *ctx, JBPacket *pkt);
+
+/* A jitter buffer is made of the packet slots and their mask, the sequence
+ * number and timestamp of the next packet to play, the frame length, the
+ * transit time and jitter estimates with the resulting target delay and its
+ * bounds, the hooks, and counters of the packets held, of the ones dropped
+ * as late or duplicate, of the ones concealed and of the resyncs.
+ */
+typedef struct {
+    JBPacket **_slots;
+    ulong _mask;
+    uint32_t _playSeq;
+    uint64_t _playTs;
+    int _started;
+    uint64_t _frameTicks;
+    int64_t _baseTransit;
+    int64_t _lastTransit;
+    double jitter;
+    uint64_t targetDelay;
+    uint64_t _minDelay;
+    uint64_t _maxDelay;
+    JBConcealFn _onConceal;
+    JBDiscardFn _onDiscard;
+    void *_ctx;
+    ulong count;
+    ulong late;
+    ulong duplicates;
+    ulong concealed;
+    ulong resyncs;
+} JitterBuffer;
+
+JitterBuffer *createJitterBuffer(ulong capacity, uint64_t frameTicks,
+                                 uint64_t minDelay, uint64_t maxDelay,
+                                 JBConcealFn onConceal, JBDiscardFn onDiscard,
+                                 void *ctx);
+void deleteJitterBuffer(JitterBuffer *jBuff);
+int jbPush(JitterBuffer *jBuff, JBPacket *pkt, uint64_t arrival);
+JBPacket *jbPop(JitterBuffer *jBuff, uint64_t now);
+
+#endif
@@ -0,0 +1,276 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage the Ring Table data structure.
+ * See the header file for a general description of the structure.
+ * See each function's comments for a description of their behaviour.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "RingTable.h"
+
+/* Tells whether a handle refers to a ring in use. */
+static inline int _rtValid(RingTable *rTable, RingHandle ring) {
+    return (rTable != NULL) && (ring < rTable->_nRings) &&
+           (rTable->_size[ring] != 0);
+}
+
+/* Grows the metadata arrays to hold the given number of rings.
+ * Returns 1 on success, 0 on failure.
+ */
+static int _rtGrowRings(RingTable *rTable, uint32_t maxRings) {
+    uint32_t **arrays[4] = {&(rTable->_offset), &(rTable->_size),
+                            &(rTable->_head), &(rTable->_count)};
+    for (int i = 0; i < 4; i++) {
+        uint32_t *newArray = realloc(*(arrays[i]),
+                                     (ulong)maxRings * sizeof(uint32_t));
+        if (newArray == NULL) return 0;  // realloc failed.
+        *(arrays[i]) = newArray;
+    }
+    rTable->_maxRings = maxRings;
+    return 1;
+}
+
+/* Grows the slab to hold at least the given number of cells.
+ * Returns 1 on success, 0 on failure.
+ */
+static int _rtGrowSlab(RingTable *rTable, ulong minSize) {
+    if (minSize > RT_INVALID) return 0;  // Offsets must fit in 32 bits.
+    ulong newSize = rTable->_slabSize ? rTable->_slabSize : 1024;
+    while (newSize < minSize) newSize *= 2;
+    if (newSize > RT_INVALID) newSize = RT_INVALID;
+    void **newSlab = realloc(rTable->_slab, newSize * sizeof(void *));
+    if (newSlab == NULL) return 0;  // realloc failed.
+    rTable->_slab = newSlab;
+    rTable->_slabSize = newSize;
+    return 1;
+}
+
+/* Returns the free list for data areas of the given size, creating it if
+ * requested. Returns NULL if there's none.
+ */
+static RTFreeList *_rtFreeList(RingTable *rTable, uint32_t size,
+                               int create) {
+    for (uint32_t i = 0; i < rTable->_nFreeLists; i++)
+        if (rTable->_freeLists[i].size == size)
+            return rTable->_freeLists + i;
+    if (!create) return NULL;
+    if (rTable->_nFreeLists == rTable->_maxFreeLists) {
+        uint32_t newMax = rTable->_maxFreeLists ?
+                          2 * rTable->_maxFreeLists : 8;
+        RTFreeList *newLists = realloc(rTable->_freeLists,
+                                       newMax * sizeof(RTFreeList));
+        if (newLists == NULL) return NULL;  // realloc failed.
+        rTable->_freeLists = newLists;
+        rTable->_maxFreeLists = newMax;
+    }
+    RTFreeList *list = rTable->_freeLists + rTable->_nFreeLists++;
+    list->size = size;
+    list->head = RT_INVALID;
+    return list;
+}
+
+/* Creates a new, empty Ring Table, sized for the given number of rings and
+ * slab cells (hints only: both grow as needed).
+ */
+RingTable *createRingTable(uint32_t ringsHint, ulong slabHint) {
+    RingTable *rTable = calloc(1, sizeof(RingTable));
+    if (rTable == NULL) return NULL;  // calloc failed.
+    rTable->_freeHandle = RT_INVALID;
+    if (!_rtGrowRings(rTable, ringsHint ? ringsHint : 64) ||
+        !_rtGrowSlab(rTable, slabHint)) {
+        deleteRingTable(rTable, 0);
+        return NULL;
+    }
+    return rTable;
+}
+
+/* Deletes a Ring Table, together with all its rings. */
+void deleteRingTable(RingTable *rTable, int toFree) {
+    if (rTable == NULL) return;
+    if (toFree)
+        // If requested, free all the entries before destroying the table.
+        for (RingHandle r = 0; r < rTable->_nRings; r++)
+            if (rTable->_size[r] != 0) rtFreeRing(rTable, r, 1);
+    free(rTable->_offset);
+    free(rTable->_size);
+    free(rTable->_head);
+    free(rTable->_count);
+    free(rTable->_slab);
+    free(rTable->_freeLists);
+    free(rTable);
+}
+
+/* Creates a new ring of the specified size in a table.
+ * Returns its handle, or RT_INVALID on failure.
+ */
+RingHandle rtNewRing(RingTable *rTable, uint32_t size) {
+    // Sanity checks.
+    if ((rTable == NULL) || (size == 0) || (size == RT_INVALID))
+        return RT_INVALID;
+    // Get a data area: reuse one of the same size, or carve a new one.
+    uint32_t offset;
+    RTFreeList *list = _rtFreeList(rTable, size, 0);
+    if ((list != NULL) && (list->head != RT_INVALID)) {
+        offset = list->head;
+        list->head = (uint32_t)(uintptr_t)(rTable->_slab[offset]);
+    } else {
+        if ((rTable->_slabUsed + size > rTable->_slabSize) &&
+            !_rtGrowSlab(rTable, rTable->_slabUsed + size))
+            return RT_INVALID;
+        offset = (uint32_t)rTable->_slabUsed;
+        rTable->_slabUsed += size;
+    }
+    // Get a handle: reuse a free one, or add a new one.
+    RingHandle ring;
+    if (rTable->_freeHandle != RT_INVALID) {
+        ring = rTable->_freeHandle;
+        rTable->_freeHandle = rTable->_offset[ring];
+    } else {
+        if ((rTable->_nRings == rTable->_maxRings) &&
+            ((rTable->_maxRings > (RT_INVALID / 2)) ||
+             !_rtGrowRings(rTable, 2 * rTable->_maxRings))) {
+            // Give the data area back.
+            list = _rtFreeList(rTable, size, 1);
+            if (list != NULL) {
+                rTable->_slab[offset] = (void *)(uintptr_t)(list->head);
+                list->head = offset;
+            }
+            return RT_INVALID;
+        }
+        ring = rTable->_nRings++;
+    }
+    // Set up the new ring.
+    rTable->_offset[ring] = offset;
+    rTable->_size[ring] = size;
+    rTable->_head[ring] = 0;
+    rTable->_count[ring] = 0;
+    return ring;
+}
+
+/* Deletes a ring, giving its data area and handle back to the table. */
+void rtFreeRing(RingTable *rTable, RingHandle ring, int toFree) {
+    if (!_rtValid(rTable, ring)) return;  // Sanity check.
+    uint32_t offset = rTable->_offset[ring], size = rTable->_size[ring];
+    if (toFree) {
+        // If requested, free all the entries before deleting the ring.
+        uint32_t idx = rTable->_head[ring];
+        for (uint32_t i = 0; i < rTable->_count[ring]; i++) {
+            free(rTable->_slab[offset + idx]);
+            if (++idx == size) idx = 0;
+        }
+    }
+    // Put the data area in its free list. If that fails, it's just lost
+    // until the table is deleted.
+    RTFreeList *list = _rtFreeList(rTable, size, 1);
+    if (list != NULL) {
+        rTable->_slab[offset] = (void *)(uintptr_t)(list->head);
+        list->head = offset;
+    }
+    rTable->_size[ring] = 0;
+    rTable->_count[ring] = 0;
+    rTable->_offset[ring] = rTable->_freeHandle;
+    rTable->_freeHandle = ring;
+}
+
+/* Returns the number of entries in a ring. */
+uint32_t rtCount(RingTable *rTable, RingHandle ring) {
+    if (!_rtValid(rTable, ring)) return 0;  // Sanity check.
+    return rTable->_count[ring];
+}
+
+/* Reads an entry from a ring. Also makes such entry unavailable.
+ * Returns the entry or NULL.
+ */
+void *rtRead(RingTable *rTable, RingHandle ring) {
+    if (!_rtValid(rTable, ring)) return NULL;  // Sanity check.
+    if (rTable->_count[ring] == 0) return NULL;  // Empty ring.
+    uint32_t head = rTable->_head[ring];
+    void *newData = rTable->_slab[rTable->_offset[ring] + head];
+    if (++head == rTable->_size[ring]) head = 0;
+    rTable->_head[ring] = head;
+    rTable->_count[ring]--;
+    return newData;
+}
+
+/* Writes an entry in a ring.
+ * Returns 1 on success, 0 if the ring was full.
+ */
+int rtWrite(RingTable *rTable, RingHandle ring, void *data) {
+    if (!_rtValid(rTable, ring) || (data == NULL)) return 0;  // Sanity check.
+    uint32_t size = rTable->_size[ring], count = rTable->_count[ring];
+    if (count == size) return 0;  // Full ring.
+    ulong tail = (ulong)rTable->_head[ring] + count;
+    if (tail >= size) tail -= size;
+    rTable->_slab[rTable->_offset[ring] + tail] = data;
+    rTable->_count[ring] = count + 1;
+    return 1;
+}
+
+/* Reads a portion of a ring, placing it in the provided area.
+ * Can be instructed to only perform the operation if there's that amount of
+ * data to read if "upTo=0".
+ * Returns the number of read operations performed.
+ */
+ulong rtCopy(RingTable *rTable, RingHandle ring, void **dataBuf,
+             ulong bufSize, int upTo) {
+    // Sanity checks.
+    if (!_rtValid(rTable, ring) || (dataBuf == NULL) || (bufSize == 0))
+        return 0;
+    uint32_t count = rTable->_count[ring], size = rTable->_size[ring];
+    // Check operation requirements.
+    if (!count || (!upTo && (count < bufSize))) return 0;
+    ulong ops = count >= bufSize ? bufSize : count;
+    void **data = rTable->_slab + rTable->_offset[ring];
+    ulong head = rTable->_head[ring];
+    ulong toEnd = size - head;
+    if (toEnd < ops) {
+        // Two separate reads, wrapping around the ring.
+        memcpy(dataBuf, data + head, toEnd * sizeof(void *));
+        memcpy(dataBuf + toEnd, data, (ops - toEnd) * sizeof(void *));
+        head = ops - toEnd;
+    } else {
+        memcpy(dataBuf, data + head, ops * sizeof(void *));
+        head += ops;
+        if (head == size) head = 0;
+    }
+    rTable->_head[ring] = (uint32_t)head;
+    rTable->_count[ring] = count - (uint32_t)ops;
+    return ops;
+}
+
+/* Writes a block of data into a ring.
+ * Can be instructed to only write to the ring if there's enough room for
+ * all the data or up to the given amount if "upTo=1".
+ * Returns the number of write operations performed.
+ */
+ulong rtPaste(RingTable *rTable, RingHandle ring, void **dataBuf,
+              ulong bufSize, int upTo) {
+    // Sanity checks.
+    if (!_rtValid(rTable, ring) || (dataBuf == NULL) || (bufSize == 0))
+        return 0;
+    uint32_t count = rTable->_count[ring], size = rTable->_size[ring];
+    ulong freeCells = size - count;
+    // Check operation requirements.
+    if (!freeCells || (!upTo && (freeCells < bufSize))) return 0;
+    ulong ops = freeCells >= bufSize ? bufSize : freeCells;
+    void **data = rTable->_slab + rTable->_offset[ring];
+    ulong tail = (ulong)rTable->_head[ring] + count;
+    if (tail >= size) tail -= size;
+    ulong toEnd = size - tail;
+    if (toEnd < ops) {
+        // Two separate writes, wrapping around the ring.
+        memcpy(data + tail, dataBuf, toEnd * sizeof(void *));
+        memcpy(data, dataBuf + toEnd, (ops - toEnd) * sizeof(void *));
+    } else {
+        memcpy(data + tail, dataBuf, ops * sizeof(void *));
+    }
+    rTable->_count[ring] = count + (uint32_t)ops;
+    return ops;
+}
@@ -0,0 +1,74 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the Ring Table
+ * data structure. See the source file for a brief description of what each
+ * function does.
+ * A ring table manages a large number of small circular buffers, which
+ * behave just like Circular Buffers but are addressed by integer handles.
+ * Instead of a separately allocated structure per buffer, the table keeps
+ * the metadata of all its rings in parallel arrays of 32-bit values (data
+ * offset, size, index of the oldest entry, entry count: 16 bytes per ring),
+ * and carves all the data areas out of a single shared slab, which grows as
+ * needed. Data areas of deleted rings are kept in per-size free lists and
+ * reused by new rings of the same size; handles are recycled too.
+ * As with Circular Buffers, entries are "void *" and NULL can't be stored.
+ * Handles stay valid when the table grows, pointers into it don't: data is
+ * only accessed through the provided routines.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef RINGTABLE_H
+#define RINGTABLE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#define RT_INVALID UINT32_MAX
+
+typedef uint32_t RingHandle;
+
+/* Free data areas of a given size form a list, linked through their first
+ * cells.
+ */
+typedef struct {
+    uint32_t size;
+    uint32_t head;
+} RTFreeList;
+
+/* A ring table is made of the per-ring metadata arrays, the shared slab and
+ * the free lists of data areas and handles.
+ * The offset of an unused handle holds the next free handle.
+ */
+typedef struct {
+    uint32_t *_offset;
+    uint32_t *_size;
+    uint32_t *_head;
+    uint32_t *_count;
+    uint32_t _nRings;
+    uint32_t _maxRings;
+    uint32_t _freeHandle;
+    void **_slab;
+    ulong _slabUsed;
+    ulong _slabSize;
+    RTFreeList *_freeLists;
+    uint32_t _nFreeLists;
+    uint32_t _maxFreeLists;
+} RingTable;
+
+RingTable *createRingTable(uint32_t ringsHint, ulong slabHint);
+void deleteRingTable(RingTable *rTable, int toFree);
+RingHandle rtNewRing(RingTable *rTable, uint32_t size);
+void rtFreeRing(RingTable *rTable, RingHandle ring, int toFree);
+uint32_t rtCount(RingTable *rTable, RingHandle ring);
+void *rtRead(RingTable *rTable, RingHandle ring);
+int rtWrite(RingTable *rTable, RingHandle ring, void *data);
+ulong rtCopy(RingTable *rTable, RingHandle ring, void **dataBuf,
+             ulong bufSize, int upTo);
+ulong rtPaste(RingTable *rTable, RingHandle ring, void **dataBuf,
+              ulong bufSize, int upTo);
+
+#endif
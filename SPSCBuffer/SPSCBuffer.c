@@ -0,0 +1,294 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage the SPSC Buffer data structure.
+ * See the header file for a general description of the structure.
+ * See each function's comments for a description of their behaviour.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "SPSCBuffer.h"
+
+/* Rounds a size up to a power of two. Returns 0 on overflow. */
+static inline ulong _spscRoundUp(ulong size) {
+    ulong res = 1;
+    while (res < size) {
+        if (res > ((ulong)-1 >> 1)) return 0;
+        res <<= 1;
+    }
+    return res;
+}
+
+/* Creates a new, empty segment of the given (power of two) size. */
+static SPSCSegment *_spscNewSegment(ulong size) {
+    SPSCSegment *seg = aligned_alloc(SPSC_CACHE_LINE, sizeof(SPSCSegment));
+    if (seg == NULL) return NULL;  // aligned_alloc failed.
+    memset(seg, 0, sizeof(SPSCSegment));
+    seg->_data = calloc(size, sizeof(void *));
+    if (seg->_data == NULL) {
+        // calloc failed.
+        free(seg);
+        return NULL;
+    }
+    seg->_mask = size - 1;
+    return seg;
+}
+
+/* Deletes a segment. */
+static void _spscFreeSegment(SPSCSegment *seg) {
+    free(seg->_data);
+    free(seg);
+}
+
+/* Producer side: returns the free cells in the write segment, refreshing
+ * the copy of the read index only if there seem to be less than needed.
+ */
+static inline ulong _spscFree(SPSCSegment *seg, ulong needed) {
+    ulong size = seg->_mask + 1;
+    ulong freeCells = size - (seg->_tail - seg->_cachedHead);
+    if (freeCells < needed) {
+        seg->_cachedHead = __atomic_load_n(&(seg->_head), __ATOMIC_ACQUIRE);
+        freeCells = size - (seg->_tail - seg->_cachedHead);
+    }
+    return freeCells;
+}
+
+/* Producer side: allocates a segment at least twice as large as the write
+ * segment, and large enough for the given number of entries.
+ * Returns NULL if the buffer can't grow that much.
+ */
+static SPSCSegment *_spscGrow(SPSCBuffer *sBuff, ulong needed) {
+    ulong size = (sBuff->_writeSeg->_mask + 1) << 1;
+    while ((size != 0) && (size < needed)) size <<= 1;
+    if ((size == 0) || (size > sBuff->_maxSize)) return NULL;
+    return _spscNewSegment(size);
+}
+
+/* Producer side: makes a new segment the write segment, linking it to the
+ * old one. The old segment must not be touched anymore after this.
+ */
+static inline void _spscLink(SPSCBuffer *sBuff, SPSCSegment *seg) {
+    SPSCSegment *old = sBuff->_writeSeg;
+    sBuff->_writeSeg = seg;
+    __atomic_store_n(&(old->_next), seg, __ATOMIC_RELEASE);
+}
+
+/* Producer side: appends entries to a segment, which must have room. */
+static inline void _spscPut(SPSCSegment *seg, void **dataBuf, ulong n) {
+    ulong size = seg->_mask + 1;
+    ulong idx = seg->_tail & seg->_mask;
+    ulong toEnd = size - idx;
+    if (toEnd < n) {
+        memcpy(seg->_data + idx, dataBuf, toEnd * sizeof(void *));
+        memcpy(seg->_data, dataBuf + toEnd, (n - toEnd) * sizeof(void *));
+    } else {
+        memcpy(seg->_data + idx, dataBuf, n * sizeof(void *));
+    }
+    __atomic_store_n(&(seg->_tail), seg->_tail + n, __ATOMIC_RELEASE);
+}
+
+/* Consumer side: removes entries from a segment, which must hold them. */
+static inline void _spscGet(SPSCSegment *seg, void **dataBuf, ulong n) {
+    ulong size = seg->_mask + 1;
+    ulong idx = seg->_head & seg->_mask;
+    ulong toEnd = size - idx;
+    if (toEnd < n) {
+        memcpy(dataBuf, seg->_data + idx, toEnd * sizeof(void *));
+        memcpy(dataBuf + toEnd, seg->_data, (n - toEnd) * sizeof(void *));
+    } else {
+        memcpy(dataBuf, seg->_data + idx, n * sizeof(void *));
+    }
+    __atomic_store_n(&(seg->_head), seg->_head + n, __ATOMIC_RELEASE);
+}
+
+/* Consumer side: returns the segment to read from and how many entries it
+ * holds, refreshing the copy of the write index only if there seem to be
+ * less than needed. If the read segment is drained and the producer has
+ * moved on, switches to the next segment and frees the old one.
+ */
+static SPSCSegment *_spscReadable(SPSCBuffer *sBuff, ulong needed,
+                                  ulong *avail) {
+    SPSCSegment *seg = sBuff->_readSeg;
+    for (;;) {
+        *avail = seg->_cachedTail - seg->_head;
+        if (*avail >= needed) return seg;
+        seg->_cachedTail = __atomic_load_n(&(seg->_tail), __ATOMIC_ACQUIRE);
+        *avail = seg->_cachedTail - seg->_head;
+        if (*avail != 0) return seg;
+        SPSCSegment *next = __atomic_load_n(&(seg->_next), __ATOMIC_ACQUIRE);
+        if (next == NULL) return seg;  // Empty buffer.
+        // The producer might have written more before moving on.
+        seg->_cachedTail = __atomic_load_n(&(seg->_tail), __ATOMIC_ACQUIRE);
+        *avail = seg->_cachedTail - seg->_head;
+        if (*avail != 0) return seg;
+        // Drained for good: the producer won't touch it again.
+        sBuff->_readSeg = next;
+        _spscFreeSegment(seg);
+        seg = next;
+    }
+}
+
+/* Creates a new SPSC Buffer of the specified size, which may grow up to the
+ * given maximum size (no growth if it's not larger than the initial size).
+ * Sizes are rounded up to powers of two.
+ */
+SPSCBuffer *createSPSCBuffer(ulong cbSize, ulong maxSize) {
+    // Sanity checks.
+    ulong size = _spscRoundUp(cbSize);
+    if ((cbSize == 0) || (size == 0)) return NULL;
+    ulong max = maxSize > size ? _spscRoundUp(maxSize) : size;
+    if (max == 0) return NULL;
+    // Allocate memory for the new structure and its first segment.
+    SPSCBuffer *sBuff = aligned_alloc(SPSC_CACHE_LINE, sizeof(SPSCBuffer));
+    if (sBuff == NULL) return NULL;  // aligned_alloc failed.
+    memset(sBuff, 0, sizeof(SPSCBuffer));
+    SPSCSegment *seg = _spscNewSegment(size);
+    if (seg == NULL) {
+        free(sBuff);
+        return NULL;
+    }
+    // Set up the new structure.
+    sBuff->_readSeg = seg;
+    sBuff->_writeSeg = seg;
+    sBuff->_maxSize = max;
+    return sBuff;
+}
+
+/* Deletes an SPSC Buffer. Neither side may be using it. */
+void deleteSPSCBuffer(SPSCBuffer *sBuff, int toFree) {
+    if (sBuff == NULL) return;
+    SPSCSegment *seg = sBuff->_readSeg;
+    while (seg != NULL) {
+        SPSCSegment *next = seg->_next;
+        if (toFree)
+            // If requested, free all the entries before destroying the
+            // structure.
+            for (ulong i = seg->_head; i != seg->_tail; i++)
+                free(seg->_data[i & seg->_mask]);
+        _spscFreeSegment(seg);
+        seg = next;
+    }
+    free(sBuff);
+}
+
+/* Returns the size of the segment the producer is writing to.
+ * Producer side only.
+ */
+ulong spscSize(SPSCBuffer *sBuff) {
+    if (sBuff == NULL) return 0;
+    return sBuff->_writeSeg->_mask + 1;
+}
+
+/* Returns the number of entries in the segment the producer is writing to,
+ * i.e. all of them unless the buffer is growing, refreshing the copy of the
+ * read index. Producer side only.
+ */
+ulong spscCount(SPSCBuffer *sBuff) {
+    if (sBuff == NULL) return 0;
+    SPSCSegment *seg = sBuff->_writeSeg;
+    seg->_cachedHead = __atomic_load_n(&(seg->_head), __ATOMIC_ACQUIRE);
+    return seg->_tail - seg->_cachedHead;
+}
+
+/* Reads an entry from the given buffer. Also makes such entry unavailable.
+ * Consumer side only.
+ * Returns the entry or NULL.
+ */
+void *spscRead(SPSCBuffer *sBuff) {
+    if (sBuff == NULL) return NULL;  // Sanity check.
+    ulong avail;
+    SPSCSegment *seg = _spscReadable(sBuff, 1, &avail);
+    if (avail == 0) return NULL;  // Empty buffer.
+    void *newData = seg->_data[seg->_head & seg->_mask];
+    __atomic_store_n(&(seg->_head), seg->_head + 1, __ATOMIC_RELEASE);
+    return newData;
+}
+
+/* Writes an entry in the given buffer, growing it if it's full and allowed.
+ * Producer side only.
+ * Returns 1 on success, 0 if the buffer was full.
+ */
+int spscWrite(SPSCBuffer *sBuff, void *data) {
+    if ((sBuff == NULL) || (data == NULL)) return 0;  // Sanity check.
+    SPSCSegment *seg = sBuff->_writeSeg;
+    if (_spscFree(seg, 1) != 0) {
+        _spscPut(seg, &data, 1);
+        return 1;
+    }
+    // Full segment: grow, filling the new one before linking it.
+    SPSCSegment *newSeg = _spscGrow(sBuff, 1);
+    if (newSeg == NULL) return 0;  // Full buffer.
+    _spscPut(newSeg, &data, 1);
+    _spscLink(sBuff, newSeg);
+    return 1;
+}
+
+/* Reads a portion of the buffer, placing it in the provided area.
+ * Can be instructed to only perform the operation if there's that amount of
+ * data to read if "upTo=0".
+ * Consumer side only.
+ * Returns the number of read operations performed.
+ */
+ulong spscCopy(SPSCBuffer *sBuff, void **dataBuf, ulong bufSize, int upTo) {
+    // Sanity checks.
+    if ((sBuff == NULL) || (dataBuf == NULL) || (bufSize == 0)) return 0;
+    ulong avail;
+    SPSCSegment *seg = _spscReadable(sBuff, bufSize, &avail);
+    if (avail == 0) return 0;  // Empty buffer.
+    if (!upTo && (avail < bufSize)) {
+        // Count what's available in the segments that follow too.
+        ulong total = avail;
+        SPSCSegment *next = __atomic_load_n(&(seg->_next), __ATOMIC_ACQUIRE);
+        while ((next != NULL) && (total < bufSize)) {
+            total += __atomic_load_n(&(next->_tail), __ATOMIC_ACQUIRE) -
+                     next->_head;
+            next = __atomic_load_n(&(next->_next), __ATOMIC_ACQUIRE);
+        }
+        if (total < bufSize) return 0;
+    }
+    // Read data from the segments, in order.
+    ulong done = 0;
+    while ((done < bufSize) && (avail != 0)) {
+        ulong ops = (bufSize - done) < avail ? (bufSize - done) : avail;
+        _spscGet(seg, dataBuf + done, ops);
+        done += ops;
+        if (done < bufSize) seg = _spscReadable(sBuff, bufSize - done, &avail);
+    }
+    return done;
+}
+
+/* Writes a block of data into the buffer, growing it if needed and allowed.
+ * Can be instructed to only write to the buffer if there's enough room for
+ * all the data or up to the given amount if "upTo=1".
+ * Producer side only.
+ * Returns the number of write operations performed.
+ */
+ulong spscPaste(SPSCBuffer *sBuff, void **dataBuf, ulong bufSize, int upTo) {
+    // Sanity checks.
+    if ((sBuff == NULL) || (dataBuf == NULL) || (bufSize == 0)) return 0;
+    SPSCSegment *seg = sBuff->_writeSeg;
+    ulong freeCells = _spscFree(seg, bufSize);
+    if (freeCells >= bufSize) {
+        // All writes fit in the current segment.
+        _spscPut(seg, dataBuf, bufSize);
+        return bufSize;
+    }
+    // Not enough room: grow, if possible, for the rest.
+    SPSCSegment *newSeg = _spscGrow(sBuff, bufSize - freeCells);
+    if (newSeg == NULL) {
+        if (!upTo || (freeCells == 0)) return 0;
+        _spscPut(seg, dataBuf, freeCells);
+        return freeCells;
+    }
+    // Fill the old segment first, since it can't be touched after linking.
+    if (freeCells != 0) _spscPut(seg, dataBuf, freeCells);
+    _spscPut(newSeg, dataBuf + freeCells, bufSize - freeCells);
+    _spscLink(sBuff, newSeg);
+    return bufSize;
+}
@@ -0,0 +1,66 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the SPSC Buffer,
+ * a lock-free circular buffer for exactly one producer thread and one
+ * consumer thread, which can grow while both keep working. See the source
+ * file for a brief description of what each function does.
+ * Entries live in a segment: a power-of-two array with its own read and
+ * write indexes, each on a cache line of its own and only ever written by
+ * one side. When the producer finds the segment full and growth is allowed,
+ * it allocates a segment twice as large, writes there from then on, and
+ * links it to the old one. The consumer goes on reading the old segment,
+ * and switches to the new one only once it has drained it: since at that
+ * point the producer has long stopped touching the old segment, the
+ * consumer can free it right away. Hence, neither side ever waits for the
+ * other, not even while the buffer grows.
+ * Operations have the same semantics as the Circular Buffer ones, but
+ * writes (and pastes) can only be made by the producer, and reads (and
+ * copies) only by the consumer.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef SPSCBUFFER_H
+#define SPSCBUFFER_H
+
+#include <sys/types.h>
+
+#define SPSC_CACHE_LINE 64
+
+/* A segment is made of its data area and its size mask, the link to the
+ * segment that follows it, and the read and write indexes, which run
+ * freely and are masked on access. Each side also keeps a copy of the other
+ * side's index, refreshed only when needed, to touch the shared line less.
+ */
+typedef struct _SPSCSegment {
+    void **_data;
+    ulong _mask;
+    struct _SPSCSegment *_next;
+    ulong _head __attribute__((aligned(SPSC_CACHE_LINE)));
+    ulong _cachedTail;
+    ulong _tail __attribute__((aligned(SPSC_CACHE_LINE)));
+    ulong _cachedHead;
+} SPSCSegment;
+
+/* An SPSC buffer is made of the segment the consumer is reading from, the
+ * one the producer is writing to, and the maximum size it may grow to.
+ */
+typedef struct {
+    SPSCSegment *_readSeg __attribute__((aligned(SPSC_CACHE_LINE)));
+    SPSCSegment *_writeSeg __attribute__((aligned(SPSC_CACHE_LINE)));
+    ulong _maxSize;
+} SPSCBuffer;
+
+SPSCBuffer *createSPSCBuffer(ulong cbSize, ulong maxSize);
+void deleteSPSCBuffer(SPSCBuffer *sBuff, int toFree);
+ulong spscSize(SPSCBuffer *sBuff);
+ulong spscCount(SPSCBuffer *sBuff);
+void *spscRead(SPSCBuffer *sBuff);
+int spscWrite(SPSCBuffer *sBuff, void *data);
+ulong spscCopy(SPSCBuffer *sBuff, void **dataBuf, ulong bufSize, int upTo);
+ulong spscPaste(SPSCBuffer *sBuff, void **dataBuf, ulong bufSize, int upTo);
+
+#endif
@@ -0,0 +1,335 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage the Shared Ring data structure.
+ * See the header file for a general description of the structure.
+ * See each function's comments for a description of their behaviour.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SharedRing.h"
+
+// Seals required on the memory file, so that no one can resize it.
+#define SR_SEALS (F_SEAL_SHRINK | F_SEAL_GROW)
+
+/* Rounds a size up to a multiple of the cache line. */
+static inline ulong _srAlign(ulong size) {
+    return (size + SR_CACHE_LINE - 1) & ~((ulong)SR_CACHE_LINE - 1);
+}
+
+/* Computes the size of a memory file holding a ring of the given (power of
+ * two) size and a data area of the given size.
+ * Returns 0 on overflow.
+ */
+static ulong _srMapSize(ulong cbSize, ulong dataSize) {
+    ulong limit = ((ulong)-1 >> 2);
+    if ((cbSize > limit / sizeof(uint64_t)) || (dataSize > limit)) return 0;
+    return _srAlign(sizeof(SRHeader)) + _srAlign(cbSize * sizeof(uint64_t)) +
+           _srAlign(dataSize);
+}
+
+/* Maps a memory file and sets up the process-local structure for it.
+ * Returns NULL on failure, without closing the file.
+ */
+static SharedRing *_srMap(int fd, ulong cbSize, ulong dataSize,
+                          ulong mapSize) {
+    SharedRing *ring = calloc(1, sizeof(SharedRing));
+    if (ring == NULL) return NULL;  // calloc failed.
+    char *area = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      fd, 0);
+    if (area == MAP_FAILED) {
+        // mmap failed.
+        free(ring);
+        return NULL;
+    }
+    ulong slotsOff = _srAlign(sizeof(SRHeader));
+    ring->_hdr = (SRHeader *)area;
+    ring->_slots = (uint64_t *)(area + slotsOff);
+    ring->data = dataSize == 0 ? NULL : area + slotsOff +
+                 _srAlign(cbSize * sizeof(uint64_t));
+    ring->cbSize = cbSize;
+    ring->dataSize = dataSize;
+    ring->_mapSize = mapSize;
+    ring->_fd = fd;
+    return ring;
+}
+
+/* Returns the entries in the ring, as seen by either side.
+ * An impossible count, which only a misbehaving peer could cause, is
+ * reported as the given fallback value.
+ */
+static inline ulong _srUsed(SharedRing *ring, uint64_t head, uint64_t tail,
+                            ulong fallback) {
+    uint64_t used = tail - head;
+    return used > ring->cbSize ? fallback : (ulong)used;
+}
+
+/* Producer side: appends entries to the ring, which must have room. */
+static inline void _srPut(SharedRing *ring, uint64_t tail, uint64_t *dataBuf,
+                          ulong n) {
+    ulong idx = (ulong)tail & (ring->cbSize - 1);
+    ulong toEnd = ring->cbSize - idx;
+    if (toEnd < n) {
+        memcpy(ring->_slots + idx, dataBuf, toEnd * sizeof(uint64_t));
+        memcpy(ring->_slots, dataBuf + toEnd, (n - toEnd) * sizeof(uint64_t));
+    } else {
+        memcpy(ring->_slots + idx, dataBuf, n * sizeof(uint64_t));
+    }
+    __atomic_store_n(&(ring->_hdr->_tail), tail + n, __ATOMIC_RELEASE);
+}
+
+/* Consumer side: removes entries from the ring, which must hold them. */
+static inline void _srGet(SharedRing *ring, uint64_t head, uint64_t *dataBuf,
+                          ulong n) {
+    ulong idx = (ulong)head & (ring->cbSize - 1);
+    ulong toEnd = ring->cbSize - idx;
+    if (toEnd < n) {
+        memcpy(dataBuf, ring->_slots + idx, toEnd * sizeof(uint64_t));
+        memcpy(dataBuf + toEnd, ring->_slots, (n - toEnd) * sizeof(uint64_t));
+    } else {
+        memcpy(dataBuf, ring->_slots + idx, n * sizeof(uint64_t));
+    }
+    __atomic_store_n(&(ring->_hdr->_head), head + n, __ATOMIC_RELEASE);
+}
+
+/* Creates a new Shared Ring of the specified size (rounded up to a power of
+ * two), in a new memory file that also holds a data area of the given size
+ * (possibly 0). The file is sealed against resizing.
+ */
+SharedRing *createSharedRing(ulong cbSize, ulong dataSize) {
+    // Sanity checks.
+    ulong size = 1;
+    while ((size < cbSize) && (size <= ((ulong)-1 >> 1))) size <<= 1;
+    if ((cbSize == 0) || (size < cbSize)) return NULL;
+    ulong mapSize = _srMapSize(size, dataSize);
+    if (mapSize == 0) return NULL;
+    // Create and size the memory file, then seal it.
+    int fd = memfd_create("SharedRing", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) return NULL;  // memfd_create failed.
+    if ((ftruncate(fd, (off_t)mapSize) != 0) ||
+        (fcntl(fd, F_ADD_SEALS, SR_SEALS | F_SEAL_SEAL) != 0)) {
+        close(fd);
+        return NULL;
+    }
+    SharedRing *ring = _srMap(fd, size, dataSize, mapSize);
+    if (ring == NULL) {
+        close(fd);
+        return NULL;
+    }
+    // Set up the shared header: the file is zero-filled, so the indexes
+    // already start from 0. The magic number goes last.
+    ring->_hdr->_cbSize = size;
+    ring->_hdr->_dataSize = dataSize;
+    __atomic_store_n(&(ring->_hdr->_magic), SR_MAGIC, __ATOMIC_RELEASE);
+    return ring;
+}
+
+/* Attaches to a Shared Ring held in the given memory file, after checking
+ * that it is sealed against resizing and that its header makes sense.
+ * On success the ring owns the file descriptor, and closes it upon
+ * deletion; on failure the descriptor is left open.
+ */
+SharedRing *srAttachFd(int fd) {
+    // Sanity checks.
+    if (fd < 0) return NULL;
+    int seals = fcntl(fd, F_GET_SEALS);
+    if ((seals < 0) || ((seals & SR_SEALS) != SR_SEALS)) return NULL;
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(SRHeader)))
+        return NULL;
+    // Read the header with a temporary mapping, then map the whole file.
+    SRHeader hdr;
+    SRHeader *shared = mmap(NULL, sizeof(SRHeader), PROT_READ, MAP_SHARED,
+                            fd, 0);
+    if (shared == MAP_FAILED) return NULL;  // mmap failed.
+    hdr._magic = __atomic_load_n(&(shared->_magic), __ATOMIC_ACQUIRE);
+    hdr._cbSize = shared->_cbSize;
+    hdr._dataSize = shared->_dataSize;
+    munmap(shared, sizeof(SRHeader));
+    if ((hdr._magic != SR_MAGIC) || (hdr._cbSize == 0) ||
+        ((hdr._cbSize & (hdr._cbSize - 1)) != 0)) return NULL;
+    ulong mapSize = _srMapSize(hdr._cbSize, hdr._dataSize);
+    if ((mapSize == 0) || ((ulong)st.st_size < mapSize)) return NULL;
+    return _srMap(fd, hdr._cbSize, hdr._dataSize, mapSize);
+}
+
+/* Closes all the file descriptors received along with a message. */
+static void _srCloseRights(struct msghdr *msg) {
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if ((cmsg->cmsg_level != SOL_SOCKET) ||
+            (cmsg->cmsg_type != SCM_RIGHTS)) continue;
+        size_t n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < n; i++) {
+            int fd;
+            memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            close(fd);
+        }
+    }
+}
+
+/* Receives a Shared Ring's memory file from a Unix domain socket, as sent
+ * by srSend, and attaches to it. Blocks as per the socket.
+ */
+SharedRing *srAttach(int sockfd) {
+    if (sockfd < 0) return NULL;  // Sanity check.
+    char byte;
+    struct iovec iov = {.iov_base = &byte, .iov_len = 1};
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } ctrl;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl.buf;
+    msg.msg_controllen = sizeof(ctrl.buf);
+    if (recvmsg(sockfd, &msg, MSG_CMSG_CLOEXEC) <= 0) return NULL;
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if ((cmsg == NULL) || (cmsg->cmsg_level != SOL_SOCKET) ||
+        (cmsg->cmsg_type != SCM_RIGHTS) ||
+        (cmsg->cmsg_len != CMSG_LEN(sizeof(int))) ||
+        (msg.msg_flags & MSG_CTRUNC)) {
+        // Not a single descriptor, or something else was sent along:
+        // drop whatever was received.
+        _srCloseRights(&msg);
+        return NULL;
+    }
+    int fd;
+    memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    SharedRing *ring = srAttachFd(fd);
+    if (ring == NULL) close(fd);
+    return ring;
+}
+
+/* Sends a Shared Ring's memory file over a Unix domain socket, so that the
+ * process on the other end can attach to it with srAttach.
+ * Returns 1 on success, 0 otherwise.
+ */
+int srSend(SharedRing *ring, int sockfd) {
+    if ((ring == NULL) || (sockfd < 0)) return 0;  // Sanity check.
+    char byte = 0;
+    struct iovec iov = {.iov_base = &byte, .iov_len = 1};
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } ctrl;
+    memset(&ctrl, 0, sizeof(ctrl));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl.buf;
+    msg.msg_controllen = sizeof(ctrl.buf);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &(ring->_fd), sizeof(int));
+    return sendmsg(sockfd, &msg, MSG_NOSIGNAL) == 1;
+}
+
+/* Detaches from a Shared Ring. The memory file is destroyed once every
+ * process has done so.
+ */
+void deleteSharedRing(SharedRing *ring) {
+    if (ring == NULL) return;
+    munmap(ring->_hdr, ring->_mapSize);
+    close(ring->_fd);
+    free(ring);
+}
+
+/* Returns the number of entries in the given ring, as seen by the caller. */
+ulong srCount(SharedRing *ring) {
+    if (ring == NULL) return 0;
+    uint64_t head = __atomic_load_n(&(ring->_hdr->_head), __ATOMIC_ACQUIRE);
+    uint64_t tail = __atomic_load_n(&(ring->_hdr->_tail), __ATOMIC_ACQUIRE);
+    return _srUsed(ring, head, tail, 0);
+}
+
+/* Reads an entry from the given ring. Also makes such entry unavailable.
+ * Consumer side only.
+ * Returns 1 and stores the entry if there was one, 0 otherwise.
+ */
+int srRead(SharedRing *ring, uint64_t *value) {
+    if ((ring == NULL) || (value == NULL)) return 0;  // Sanity check.
+    uint64_t head = __atomic_load_n(&(ring->_hdr->_head), __ATOMIC_RELAXED);
+    uint64_t tail = __atomic_load_n(&(ring->_hdr->_tail), __ATOMIC_ACQUIRE);
+    if (_srUsed(ring, head, tail, 0) == 0) return 0;  // Empty ring.
+    *value = ring->_slots[(ulong)head & (ring->cbSize - 1)];
+    __atomic_store_n(&(ring->_hdr->_head), head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Writes an entry into the given ring, if there's enough space.
+ * Producer side only.
+ * Returns 1 on success, 0 otherwise.
+ */
+int srWrite(SharedRing *ring, uint64_t value) {
+    if (ring == NULL) return 0;  // Sanity check.
+    uint64_t tail = __atomic_load_n(&(ring->_hdr->_tail), __ATOMIC_RELAXED);
+    uint64_t head = __atomic_load_n(&(ring->_hdr->_head), __ATOMIC_ACQUIRE);
+    if (_srUsed(ring, head, tail, ring->cbSize) == ring->cbSize)
+        return 0;  // Full ring.
+    ring->_slots[(ulong)tail & (ring->cbSize - 1)] = value;
+    __atomic_store_n(&(ring->_hdr->_tail), tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Copies entries from the given ring to the provided array, making them
+ * unavailable. If "upTo" is set, copies as many as possible (up to the
+ * array's size), otherwise all of them or none.
+ * Consumer side only.
+ * Returns the number of entries copied.
+ */
+ulong srCopy(SharedRing *ring, uint64_t *dataBuf, ulong bufSize, int upTo) {
+    // Sanity check.
+    if ((ring == NULL) || (dataBuf == NULL) || (bufSize == 0)) return 0;
+    uint64_t head = __atomic_load_n(&(ring->_hdr->_head), __ATOMIC_RELAXED);
+    uint64_t tail = __atomic_load_n(&(ring->_hdr->_tail), __ATOMIC_ACQUIRE);
+    ulong avail = _srUsed(ring, head, tail, 0);
+    ulong ops = bufSize;
+    if (avail < bufSize) {
+        if (!upTo) return 0;  // Not enough entries.
+        ops = avail;
+    }
+    if (ops == 0) return 0;  // Empty ring.
+    _srGet(ring, head, dataBuf, ops);
+    return ops;
+}
+
+/* Pastes entries from the provided array into the given ring. If "upTo" is
+ * set, pastes as many as possible (up to the array's size), otherwise all of
+ * them or none.
+ * Producer side only.
+ * Returns the number of entries pasted.
+ */
+ulong srPaste(SharedRing *ring, uint64_t *dataBuf, ulong bufSize, int upTo) {
+    // Sanity check.
+    if ((ring == NULL) || (dataBuf == NULL) || (bufSize == 0)) return 0;
+    uint64_t tail = __atomic_load_n(&(ring->_hdr->_tail), __ATOMIC_RELAXED);
+    uint64_t head = __atomic_load_n(&(ring->_hdr->_head), __ATOMIC_ACQUIRE);
+    ulong freeCells = ring->cbSize - _srUsed(ring, head, tail, ring->cbSize);
+    ulong ops = bufSize;
+    if (freeCells < bufSize) {
+        if (!upTo) return 0;  // Not enough room.
+        ops = freeCells;
+    }
+    if (ops == 0) return 0;  // Full ring.
+    _srPut(ring, tail, dataBuf, ops);
+    return ops;
+}
@@ -0,0 +1,74 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the Shared Ring,
+ * a lock-free circular buffer for one producer and one consumer living in
+ * different processes. See the source file for a brief description of what
+ * each function does.
+ * The whole ring lives in an anonymous memory file (memfd), so it has no
+ * name in any filesystem: the process that creates it hands the file
+ * descriptor over a Unix domain socket (SCM_RIGHTS), and the receiving
+ * process maps it and attaches to a ring that is ready to use.
+ * Since the two processes map the file at different addresses, the shared
+ * area holds no pointers at all: entries are 64-bit values, and the read
+ * and write indexes are free-running counters, masked on access and updated
+ * atomically, each on a cache line of its own.
+ * The memory file can also hold a data area, after the ring, that both
+ * processes can access: entries can then carry offsets inside it, so that
+ * payloads are exchanged without being copied.
+ * Either process may be the producer, and the other one the consumer.
+ * A peer is not trusted: indexes read from the shared area are checked
+ * before they are used.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef SHAREDRING_H
+#define SHAREDRING_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#define SR_CACHE_LINE 64
+#define SR_MAGIC 0x31474e4952524853UL  // "SHRRING1"
+
+/* The shared header is at the start of the memory file, and holds what a
+ * process needs to validate the ring when attaching, together with the
+ * read and write indexes.
+ */
+typedef struct {
+    uint64_t _magic;
+    uint64_t _cbSize;
+    uint64_t _dataSize;
+    uint64_t _head __attribute__((aligned(SR_CACHE_LINE)));
+    uint64_t _tail __attribute__((aligned(SR_CACHE_LINE)));
+} SRHeader;
+
+/* A Shared Ring, as seen by a process, is made of its mapping of the memory
+ * file (with pointers to the shared header, the entries and the data area),
+ * the sizes of both areas, and the file descriptor.
+ */
+typedef struct {
+    SRHeader *_hdr;
+    uint64_t *_slots;
+    char *data;
+    ulong cbSize;
+    ulong dataSize;
+    ulong _mapSize;
+    int _fd;
+} SharedRing;
+
+SharedRing *createSharedRing(ulong cbSize, ulong dataSize);
+SharedRing *srAttach(int sockfd);
+SharedRing *srAttachFd(int fd);
+int srSend(SharedRing *ring, int sockfd);
+void deleteSharedRing(SharedRing *ring);
+ulong srCount(SharedRing *ring);
+int srRead(SharedRing *ring, uint64_t *value);
+int srWrite(SharedRing *ring, uint64_t value);
+ulong srCopy(SharedRing *ring, uint64_t *dataBuf, ulong bufSize, int upTo);
+ulong srPaste(SharedRing *ring, uint64_t *dataBuf, ulong bufSize, int upTo);
+
+#endif
@@ -0,0 +1,205 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage the Stream Join data structure.
+ * See the header file for a general description of the structure.
+ * See each function's comments for a description of their behaviour.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+
+#include "StreamJoin.h"
+
+/* Returns the hash bucket of a key (Fibonacci hashing). */
+static inline ulong _sjBucket(SJWindow *win, uint64_t key) {
+    return (ulong)((key * 0x9E3779B97F4A7C15UL) >> 32) & win->_mask;
+}
+
+/* Sets up a window that holds up to the given number of events.
+ * Returns 1 on success, 0 otherwise.
+ */
+static int _sjInitWindow(SJWindow *win, ulong capacity) {
+    ulong buckets = 1;
+    while (buckets < capacity) buckets <<= 1;
+    win->_nodes = calloc(capacity, sizeof(SJNode));
+    win->_heads = calloc(buckets, sizeof(SJNode *));
+    win->_tails = calloc(buckets, sizeof(SJNode *));
+    if ((win->_nodes == NULL) || (win->_heads == NULL) ||
+        (win->_tails == NULL)) {
+        // calloc failed.
+        free(win->_nodes);
+        free(win->_heads);
+        free(win->_tails);
+        return 0;
+    }
+    win->_cap = capacity;
+    win->_head = 0;
+    win->_count = 0;
+    win->_mask = buckets - 1;
+    return 1;
+}
+
+/* Frees a window's memory. */
+static void _sjFreeWindow(SJWindow *win) {
+    free(win->_nodes);
+    free(win->_heads);
+    free(win->_tails);
+}
+
+/* Removes the oldest event from a window, handing it back to the caller. */
+static void _sjEvict(StreamJoin *join, int side) {
+    SJWindow *win = join->_windows + side;
+    SJNode *node = win->_nodes + win->_head;
+    ulong b = _sjBucket(win, node->event->key);
+    // The oldest event is at the head of its bucket.
+    win->_heads[b] = node->_next;
+    if (win->_heads[b] == NULL) win->_tails[b] = NULL;
+    win->_head = win->_head + 1 == win->_cap ? 0 : win->_head + 1;
+    win->_count--;
+    if (join->_onExpire != NULL)
+        join->_onExpire(join->_ctx, node->event, side);
+}
+
+/* Adds an event to a window, which must not be full. */
+static void _sjInsert(SJWindow *win, SJEvent *event) {
+    ulong idx = win->_head + win->_count;
+    if (idx >= win->_cap) idx -= win->_cap;
+    SJNode *node = win->_nodes + idx;
+    ulong b = _sjBucket(win, event->key);
+    node->event = event;
+    node->_next = NULL;
+    if (win->_tails[b] == NULL) win->_heads[b] = node;
+    else win->_tails[b]->_next = node;
+    win->_tails[b] = node;
+    win->_count++;
+}
+
+/* Evicts the events of a window that are older than the given time. */
+static void _sjExpire(StreamJoin *join, int side, uint64_t oldest) {
+    SJWindow *win = join->_windows + side;
+    while ((win->_count != 0) &&
+           (win->_nodes[win->_head].event->timestamp < oldest))
+        _sjEvict(join, side);
+}
+
+/* Emits the matches of an event with the events in the other window. */
+static void _sjProbe(StreamJoin *join, int side, SJEvent *event) {
+    SJWindow *other = join->_windows + (side ^ 1);
+    SJNode *node = other->_heads[_sjBucket(other, event->key)];
+    for (; node != NULL; node = node->_next) {
+        if (node->event->key != event->key) continue;
+        if (side == SJ_LEFT) join->_onMatch(join->_ctx, event, node->event);
+        else join->_onMatch(join->_ctx, node->event, event);
+        join->matches++;
+    }
+}
+
+/* Creates a new Stream Join of the events coming in the given buffers, with
+ * the given window length (in the timestamps' unit). Each side holds up to
+ * "capacity" events within the window: older ones are evicted early if more
+ * come in.
+ * "onMatch" is required, while "onExpire" may be NULL.
+ */
+StreamJoin *createStreamJoin(CircBuffer *left, CircBuffer *right,
+                             uint64_t window, ulong capacity,
+                             SJMatchFn onMatch, SJExpireFn onExpire,
+                             void *ctx) {
+    // Sanity checks.
+    if ((left == NULL) || (right == NULL) || (left == right) ||
+        (capacity == 0) || (capacity > ((ulong)-1 >> 2)) ||
+        (onMatch == NULL)) return NULL;
+    // Allocate memory for the new structure and its windows.
+    StreamJoin *join = calloc(1, sizeof(StreamJoin));
+    if (join == NULL) return NULL;  // calloc failed.
+    if (!_sjInitWindow(join->_windows + SJ_LEFT, capacity)) {
+        free(join);
+        return NULL;
+    }
+    if (!_sjInitWindow(join->_windows + SJ_RIGHT, capacity)) {
+        _sjFreeWindow(join->_windows + SJ_LEFT);
+        free(join);
+        return NULL;
+    }
+    // Set up the new structure.
+    join->_inputs[SJ_LEFT] = left;
+    join->_inputs[SJ_RIGHT] = right;
+    join->window = window;
+    join->_onMatch = onMatch;
+    join->_onExpire = onExpire;
+    join->_ctx = ctx;
+    return join;
+}
+
+/* Deletes a Stream Join. The events it still holds are handed back to the
+ * caller, while the ones still in the input buffers are left there.
+ */
+void deleteStreamJoin(StreamJoin *join) {
+    if (join == NULL) return;
+    for (int side = SJ_LEFT; side <= SJ_RIGHT; side++) {
+        while (join->_windows[side]._count != 0) _sjEvict(join, side);
+        if ((join->_pending[side] != NULL) && (join->_onExpire != NULL))
+            join->_onExpire(join->_ctx, join->_pending[side], side);
+        _sjFreeWindow(join->_windows + side);
+    }
+    free(join);
+}
+
+/* Takes events from the input buffers, oldest first, and joins them.
+ * If one buffer is empty, the next event in it might come before the ones
+ * in the other buffer, so the join stops there, unless "drain" is set.
+ * Returns the number of events taken.
+ */
+ulong sjJoin(StreamJoin *join, int drain) {
+    if (join == NULL) return 0;  // Sanity check.
+    ulong taken = 0;
+    for (;;) {
+        // Get the next event from each side, if there's none already.
+        for (int side = SJ_LEFT; side <= SJ_RIGHT; side++)
+            if (join->_pending[side] == NULL)
+                join->_pending[side] = cbRead(join->_inputs[side]);
+        SJEvent *left = join->_pending[SJ_LEFT];
+        SJEvent *right = join->_pending[SJ_RIGHT];
+        if ((left == NULL) && (right == NULL)) break;
+        if (((left == NULL) || (right == NULL)) && !drain) break;
+        // Take the oldest one, the left one on ties.
+        int side = SJ_LEFT;
+        if ((left == NULL) ||
+            ((right != NULL) && (right->timestamp < left->timestamp)))
+            side = SJ_RIGHT;
+        SJEvent *event = join->_pending[side];
+        join->_pending[side] = NULL;
+        taken++;
+        // Move time forward and evict what fell out of the window.
+        if (event->timestamp > join->_now) join->_now = event->timestamp;
+        uint64_t oldest = join->_now > join->window ?
+                          join->_now - join->window : 0;
+        _sjExpire(join, SJ_LEFT, oldest);
+        _sjExpire(join, SJ_RIGHT, oldest);
+        if (event->timestamp < oldest) {
+            // Out of order and too late to match anything.
+            if (join->_onExpire != NULL)
+                join->_onExpire(join->_ctx, event, side);
+            continue;
+        }
+        _sjProbe(join, side, event);
+        SJWindow *win = join->_windows + side;
+        if (win->_count == win->_cap) {
+            // Full window: evict the oldest event early.
+            _sjEvict(join, side);
+            join->dropped++;
+        }
+        _sjInsert(win, event);
+    }
+    return taken;
+}
+
+/* Returns the number of events in the window of the given side. */
+ulong sjCount(StreamJoin *join, int side) {
+    if ((join == NULL) || ((side != SJ_LEFT) && (side != SJ_RIGHT)))
+        return 0;
+    return join->_windows[side]._count;
+}
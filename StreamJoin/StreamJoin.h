@@ -0,0 +1,100 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the Stream Join,
+ * a windowed equi-join of two event streams. See the source file for a
+ * brief description of what each function does.
+ * Each stream comes in its own Circular Buffer, as pointers to events in
+ * timestamp order. Events start with an SJEvent header, which holds their
+ * timestamp and join key. A pair of events, one per stream, matches if they
+ * have the same key and their timestamps are at most a window apart.
+ * The join walks both buffers at once with a merge-style cursor, always
+ * taking the oldest event available, so that time only moves forward.
+ * For each stream, it keeps the events within the window in arrival order,
+ * together with a small hash index by key. When an event is taken, the
+ * events that fell out of the window are evicted from both sides, then the
+ * other side's index is probed to emit the matches, and finally the event
+ * is added to its own side. Hence, every event is handled in O(1) expected
+ * time, plus the matches it yields, instead of scanning a whole window.
+ * Each match is emitted once, when the later of the two events is taken.
+ * Events are owned by the caller, who is told when the join is done with
+ * each of them, so that they can be freed.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef STREAMJOIN_H
+#define STREAMJOIN_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "../CircularBuffer/CircularBuffer.h"
+
+// Stream sides.
+#define SJ_LEFT 0
+#define SJ_RIGHT 1
+
+/* Header that events must start with. */
+typedef struct {
+    uint64_t timestamp;
+    uint64_t key;
+} SJEvent;
+
+/* Called for every match, with the left and the right event. */
+typedef void (*SJMatchFn)(void *ctx, SJEvent *left, SJEvent *right);
+
+/* Called when the join is done with an event of the given side. */
+typedef void (*SJExpireFn)(void *ctx, SJEvent *event, int side);
+
+/* A window node holds an event, and links it to the next one in the same
+ * hash bucket.
+ */
+typedef struct _SJNode {
+    SJEvent *event;
+    struct _SJNode *_next;
+} SJNode;
+
+/* A window is made of a pool of nodes, used as a circular array in arrival
+ * order, and of the hash buckets. Events are evicted in arrival order, so
+ * each bucket's oldest node is at its head, and new ones go at its tail.
+ */
+typedef struct {
+    SJNode *_nodes;
+    ulong _cap;
+    ulong _head;
+    ulong _count;
+    SJNode **_heads;
+    SJNode **_tails;
+    ulong _mask;
+} SJWindow;
+
+/* A stream join is made of the two input buffers with the next event taken
+ * from each one, the two windows, the window length and the current time,
+ * the callbacks, and counters of the matches emitted and of the events
+ * evicted early because their window was full.
+ */
+typedef struct {
+    CircBuffer *_inputs[2];
+    SJEvent *_pending[2];
+    SJWindow _windows[2];
+    uint64_t window;
+    uint64_t _now;
+    SJMatchFn _onMatch;
+    SJExpireFn _onExpire;
+    void *_ctx;
+    ulong matches;
+    ulong dropped;
+} StreamJoin;
+
+StreamJoin *createStreamJoin(CircBuffer *left, CircBuffer *right,
+                             uint64_t window, ulong capacity,
+                             SJMatchFn onMatch, SJExpireFn onExpire,
+                             void *ctx);
+void deleteStreamJoin(StreamJoin *join);
+ulong sjJoin(StreamJoin *join, int drain);
+ulong sjCount(StreamJoin *join, int side);
+
+#endif
@@ -0,0 +1,178 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage the Value Buffer data structure.
+ * See the header file for a general description of the structure.
+ * See each function's comments for a description of their behaviour.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ValueBuffer.h"
+
+/* Returns the address of the element in the given cell. */
+static inline char *_vbCell(ValueBuffer *vBuff, ulong idx) {
+    return vBuff->_data + idx * vBuff->_type.size;
+}
+
+/* Moves a run of elements between two non-overlapping areas. */
+static inline void _vbMoveRun(ValueBuffer *vBuff, char *dst, char *src,
+                              ulong n) {
+    size_t size = vBuff->_type.size;
+    if (vBuff->_type.move == NULL) {
+        memcpy(dst, src, n * size);
+        return;
+    }
+    for (ulong i = 0; i < n; i++)
+        vBuff->_type.move(dst + i * size, src + i * size);
+}
+
+/* Destroys the oldest element and removes it from the buffer. */
+static inline void _vbDropOldest(ValueBuffer *vBuff) {
+    if (vBuff->_type.destroy != NULL)
+        vBuff->_type.destroy(_vbCell(vBuff, vBuff->_readIdx));
+    if (++vBuff->_readIdx == vBuff->cbSize) vBuff->_readIdx = 0;
+    vBuff->dataCount--;
+}
+
+/* Creates a new Value Buffer of the specified size, for elements of the
+ * given type (whose descriptor is copied).
+ */
+ValueBuffer *createVBuffer(ulong cbSize, const VBElemType *type) {
+    // Sanity checks.
+    if ((cbSize == 0) || (type == NULL) || (type->size == 0) ||
+        (type->align == 0) || ((type->align & (type->align - 1)) != 0) ||
+        ((type->size % type->align) != 0) ||
+        (cbSize > ((size_t)-1 / type->size))) return NULL;
+    // Allocate memory for the new structure and its data area, which must
+    // be a multiple of the alignment.
+    ValueBuffer *vBuff = calloc(1, sizeof(ValueBuffer));
+    if (vBuff == NULL) return NULL;  // calloc failed.
+    size_t align = type->align < sizeof(void *) ? sizeof(void *) :
+                   type->align;
+    size_t areaSize = (cbSize * type->size + align - 1) & ~(align - 1);
+    vBuff->_data = aligned_alloc(align, areaSize);
+    if (vBuff->_data == NULL) {
+        // aligned_alloc failed.
+        free(vBuff);
+        return NULL;
+    }
+    // Set up the new structure.
+    vBuff->_type = *type;
+    vBuff->cbSize = cbSize;
+    return vBuff;
+}
+
+/* Deletes a Value Buffer, destroying the elements it still holds. */
+void deleteVBuffer(ValueBuffer *vBuff) {
+    if (vBuff == NULL) return;
+    if (vBuff->_type.destroy != NULL)
+        while (vBuff->dataCount != 0) _vbDropOldest(vBuff);
+    free(vBuff->_data);
+    free(vBuff);
+}
+
+/* Returns the address of the i-th oldest element, starting from 0, which
+ * stays in the buffer, or NULL if there's no such element.
+ */
+void *vbPeek(ValueBuffer *vBuff, ulong i) {
+    if ((vBuff == NULL) || (i >= vBuff->dataCount)) return NULL;
+    ulong idx = vBuff->_readIdx + i;
+    if (idx >= vBuff->cbSize) idx -= vBuff->cbSize;
+    return _vbCell(vBuff, idx);
+}
+
+/* Moves the oldest element out of the buffer, into the provided storage.
+ * Returns 1 on success, 0 if the buffer was empty.
+ */
+int vbRead(ValueBuffer *vBuff, void *elem) {
+    // Sanity check.
+    if ((vBuff == NULL) || (elem == NULL) || (vBuff->dataCount == 0))
+        return 0;
+    _vbMoveRun(vBuff, elem, _vbCell(vBuff, vBuff->_readIdx), 1);
+    if (++vBuff->_readIdx == vBuff->cbSize) vBuff->_readIdx = 0;
+    vBuff->dataCount--;
+    return 1;
+}
+
+/* Moves an element into the buffer, if there's enough space; it then
+ * belongs to the buffer.
+ * Returns 1 on success, 0 otherwise (the element is left untouched).
+ */
+int vbWrite(ValueBuffer *vBuff, void *elem) {
+    // Sanity check.
+    if ((vBuff == NULL) || (elem == NULL) ||
+        (vBuff->dataCount == vBuff->cbSize)) return 0;
+    _vbMoveRun(vBuff, _vbCell(vBuff, vBuff->_writeIdx), elem, 1);
+    if (++vBuff->_writeIdx == vBuff->cbSize) vBuff->_writeIdx = 0;
+    vBuff->dataCount++;
+    return 1;
+}
+
+/* Moves an element into the buffer, destroying the oldest one to make room
+ * for it if the buffer is full.
+ * Returns 1 if an element was overwritten, 0 otherwise.
+ */
+int vbOverwrite(ValueBuffer *vBuff, void *elem) {
+    if ((vBuff == NULL) || (elem == NULL)) return 0;  // Sanity check.
+    int full = vBuff->dataCount == vBuff->cbSize;
+    if (full) _vbDropOldest(vBuff);
+    vbWrite(vBuff, elem);
+    return full;
+}
+
+/* Moves elements out of the buffer, into the provided array. If "upTo" is
+ * set, moves as many as possible (up to the array's size), otherwise all of
+ * them or none.
+ * Returns the number of elements moved.
+ */
+ulong vbCopy(ValueBuffer *vBuff, void *dataBuf, ulong bufSize, int upTo) {
+    // Sanity check.
+    if ((vBuff == NULL) || (dataBuf == NULL) || (bufSize == 0)) return 0;
+    ulong ops = bufSize;
+    if (vBuff->dataCount < bufSize) {
+        if (!upTo) return 0;  // Not enough elements.
+        ops = vBuff->dataCount;
+    }
+    // Move elements out of the buffer, in one or two runs.
+    ulong toEnd = vBuff->cbSize - vBuff->_readIdx;
+    ulong first = ops < toEnd ? ops : toEnd;
+    char *dst = dataBuf;
+    _vbMoveRun(vBuff, dst, _vbCell(vBuff, vBuff->_readIdx), first);
+    _vbMoveRun(vBuff, dst + first * vBuff->_type.size, vBuff->_data,
+               ops - first);
+    vBuff->_readIdx = ops < toEnd ? vBuff->_readIdx + ops : ops - toEnd;
+    vBuff->dataCount -= ops;
+    return ops;
+}
+
+/* Moves elements from the provided array into the buffer, where they then
+ * belong. If "upTo" is set, moves as many as possible (up to the array's
+ * size), otherwise all of them or none.
+ * Returns the number of elements moved.
+ */
+ulong vbPaste(ValueBuffer *vBuff, void *dataBuf, ulong bufSize, int upTo) {
+    // Sanity check.
+    if ((vBuff == NULL) || (dataBuf == NULL) || (bufSize == 0)) return 0;
+    ulong freeCells = vBuff->cbSize - vBuff->dataCount;
+    ulong ops = bufSize;
+    if (freeCells < bufSize) {
+        if (!upTo) return 0;  // Not enough room.
+        ops = freeCells;
+    }
+    // Move elements into the buffer, in one or two runs.
+    ulong toEnd = vBuff->cbSize - vBuff->_writeIdx;
+    ulong first = ops < toEnd ? ops : toEnd;
+    char *src = dataBuf;
+    _vbMoveRun(vBuff, _vbCell(vBuff, vBuff->_writeIdx), src, first);
+    _vbMoveRun(vBuff, vBuff->_data, src + first * vBuff->_type.size,
+               ops - first);
+    vBuff->_writeIdx = ops < toEnd ? vBuff->_writeIdx + ops : ops - toEnd;
+    vBuff->dataCount += ops;
+    return ops;
+}
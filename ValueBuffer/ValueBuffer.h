@@ -0,0 +1,65 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the Value
+ * Buffer, a circular buffer that stores its elements by value. See the
+ * source file for a brief description of what each function does.
+ * Elements are described at creation by a type descriptor: their size and
+ * alignment, and, for elements that own resources, how to move them from
+ * one place to another and how to destroy them. Elements moved into the
+ * buffer belong to it until they are moved out again: those that are
+ * dropped, by an overwrite or upon deletion, are destroyed.
+ * Types whose elements can be moved by just copying their bytes (e.g. that
+ * hold no pointers into themselves), even if they own resources, are
+ * trivially relocatable and need no move hook: blocks of them are then
+ * moved with memcpy, as plain buffers do, rather than one by one.
+ * Elements live in the buffer's own data area, so no per-element memory is
+ * allocated.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef VALUEBUFFER_H
+#define VALUEBUFFER_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/* An element type descriptor. "move" constructs an element in "dst" taking
+ * over the contents of "src", after which "src" is no longer an element and
+ * must not be destroyed; if it's NULL, the type is trivially relocatable
+ * and elements are moved with memcpy.
+ * "destroy" releases what an element owns, and may be NULL.
+ */
+typedef struct {
+    size_t size;
+    size_t align;
+    void (*move)(void *dst, void *src);
+    void (*destroy)(void *elem);
+} VBElemType;
+
+/* A value buffer is made of its element type, a data area and its length,
+ * the positions of the oldest element and of the next free cell, and a
+ * counter of the elements held.
+ */
+typedef struct {
+    VBElemType _type;
+    char *_data;
+    ulong cbSize;
+    ulong _readIdx;
+    ulong _writeIdx;
+    ulong dataCount;
+} ValueBuffer;
+
+ValueBuffer *createVBuffer(ulong cbSize, const VBElemType *type);
+void deleteVBuffer(ValueBuffer *vBuff);
+void *vbPeek(ValueBuffer *vBuff, ulong i);
+int vbRead(ValueBuffer *vBuff, void *elem);
+int vbWrite(ValueBuffer *vBuff, void *elem);
+int vbOverwrite(ValueBuffer *vBuff, void *elem);
+ulong vbCopy(ValueBuffer *vBuff, void *dataBuf, ulong bufSize, int upTo);
+ulong vbPaste(ValueBuffer *vBuff, void *dataBuf, ulong bufSize, int upTo);
+
+#endif
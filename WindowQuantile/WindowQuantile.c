@@ -0,0 +1,202 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains functions to manage the Quantile Window data structure.
+ * See the header file for a general description of the structure.
+ * See each function's comments for a description of their behaviour.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "WindowQuantile.h"
+
+/* Returns the size of a (possibly empty) subtree. */
+static inline ulong _qwSize(QWNode *node) {
+    return node == NULL ? 0 : node->_size;
+}
+
+/* Recomputes the subtree size of a node from its children. */
+static inline void _qwUpdate(QWNode *node) {
+    node->_size = 1 + _qwSize(node->_left) + _qwSize(node->_right);
+}
+
+/* Orders nodes by value, then by arrival. */
+static inline int _qwLess(QWNode *a, QWNode *b) {
+    if (a->value != b->value) return a->value < b->value;
+    return a->_seq < b->_seq;
+}
+
+/* Generates a new node priority (xorshift64). */
+static inline ulong _qwRandom(QuantileWindow *qWin) {
+    ulong x = qWin->_rngState;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    qWin->_rngState = x;
+    return x;
+}
+
+/* Splits a subtree in the nodes that come before a key, and the rest. */
+static void _qwSplit(QWNode *root, QWNode *key, QWNode **left,
+                     QWNode **right) {
+    if (root == NULL) {
+        *left = NULL;
+        *right = NULL;
+    } else if (_qwLess(root, key)) {
+        _qwSplit(root->_right, key, &(root->_right), right);
+        *left = root;
+        _qwUpdate(root);
+    } else {
+        _qwSplit(root->_left, key, left, &(root->_left));
+        *right = root;
+        _qwUpdate(root);
+    }
+}
+
+/* Merges two subtrees, given that all keys in the left one come first. */
+static QWNode *_qwMerge(QWNode *left, QWNode *right) {
+    if (left == NULL) return right;
+    if (right == NULL) return left;
+    if (left->_prio > right->_prio) {
+        left->_right = _qwMerge(left->_right, right);
+        _qwUpdate(left);
+        return left;
+    }
+    right->_left = _qwMerge(left, right->_left);
+    _qwUpdate(right);
+    return right;
+}
+
+/* Inserts a node in a subtree, returns the new subtree root. */
+static QWNode *_qwInsert(QWNode *root, QWNode *node) {
+    if (root == NULL) return node;
+    if (node->_prio > root->_prio) {
+        // The new node becomes the root of this subtree.
+        _qwSplit(root, node, &(node->_left), &(node->_right));
+        _qwUpdate(node);
+        return node;
+    }
+    if (_qwLess(node, root)) root->_left = _qwInsert(root->_left, node);
+    else root->_right = _qwInsert(root->_right, node);
+    _qwUpdate(root);
+    return root;
+}
+
+/* Removes a node from a subtree, returns the new subtree root. */
+static QWNode *_qwRemove(QWNode *root, QWNode *node) {
+    if (root == node) return _qwMerge(root->_left, root->_right);
+    if (_qwLess(node, root)) root->_left = _qwRemove(root->_left, node);
+    else root->_right = _qwRemove(root->_right, node);
+    _qwUpdate(root);
+    return root;
+}
+
+/* Creates a new Quantile Window that holds the given number of samples. */
+QuantileWindow *createQWindow(ulong winSize) {
+    // Sanity check.
+    if (winSize == 0) return NULL;
+    // Allocate memory for the new structure, its nodes and its buffer.
+    QuantileWindow *qWin = calloc(1, sizeof(QuantileWindow));
+    if (qWin == NULL) return NULL;  // calloc failed.
+    qWin->_nodes = calloc(winSize, sizeof(QWNode));
+    if (qWin->_nodes == NULL) {
+        // calloc failed.
+        free(qWin);
+        return NULL;
+    }
+    qWin->_window = createCBuffer(winSize);
+    if (qWin->_window == NULL) {
+        // createCBuffer failed.
+        free(qWin->_nodes);
+        free(qWin);
+        return NULL;
+    }
+    // Set up the new structure.
+    qWin->_root = NULL;
+    qWin->_seq = 0;
+    qWin->_rngState = 0x9E3779B97F4A7C15UL ^ (ulong)qWin;
+    return qWin;
+}
+
+/* Deletes a Quantile Window. */
+void deleteQWindow(QuantileWindow *qWin) {
+    if (qWin == NULL) return;
+    // Nodes belong to the pool, so the buffer must not free them.
+    deleteCBuffer(qWin->_window, 0);
+    free(qWin->_nodes);
+    free(qWin);
+}
+
+/* Adds a sample to the given window, evicting the oldest one if it's full.
+ * Returns 1 on success, 0 if the sample was not a number.
+ */
+int qwPush(QuantileWindow *qWin, double sample) {
+    if ((qWin == NULL) || isnan(sample)) return 0;  // Sanity check.
+    QWNode *node;
+    if (qWin->_window->dataCount == qWin->_window->cbSize) {
+        // Full window: evict the oldest sample and recycle its node.
+        node = cbRead(qWin->_window);
+        qWin->_root = _qwRemove(qWin->_root, node);
+    } else {
+        // Nodes are only recycled once the window is full, so the next free
+        // one in the pool is the one right after the samples held.
+        node = qWin->_nodes + qWin->_window->dataCount;
+    }
+    // Set up the node and place it in both structures.
+    node->value = sample;
+    node->_seq = qWin->_seq++;
+    node->_prio = _qwRandom(qWin);
+    node->_size = 1;
+    node->_left = NULL;
+    node->_right = NULL;
+    qWin->_root = _qwInsert(qWin->_root, node);
+    cbWrite(qWin->_window, node);
+    return 1;
+}
+
+/* Returns the number of samples currently held in the given window. */
+ulong qwCount(QuantileWindow *qWin) {
+    if (qWin == NULL) return 0;
+    return qWin->_window->dataCount;
+}
+
+/* Returns the k-th smallest sample in the window, starting from 0.
+ * Returns NAN if there's no such sample.
+ */
+double qwRank(QuantileWindow *qWin, ulong k) {
+    if ((qWin == NULL) || (k >= qwCount(qWin))) return NAN;  // Sanity check.
+    QWNode *curr = qWin->_root;
+    while (curr != NULL) {
+        ulong leftSize = _qwSize(curr->_left);
+        if (k < leftSize) {
+            curr = curr->_left;
+        } else if (k == leftSize) {
+            return curr->value;
+        } else {
+            k -= leftSize + 1;
+            curr = curr->_right;
+        }
+    }
+    return NAN;  // Should never get here.
+}
+
+/* Returns the given quantile (from 0.0 to 1.0) of the samples in the window,
+ * according to the nearest-rank method (e.g. 0.99 returns the p99).
+ * Returns NAN if the window is empty.
+ */
+double qwQuantile(QuantileWindow *qWin, double q) {
+    ulong count = qwCount(qWin);
+    if ((count == 0) || isnan(q)) return NAN;  // Sanity checks.
+    if (q <= 0.0) return qwRank(qWin, 0);
+    if (q >= 1.0) return qwRank(qWin, count - 1);
+    // The nearest rank is the ceiling of q * count, starting from 1.
+    double exact = q * (double)count;
+    ulong rank = (ulong)exact;
+    if ((double)rank < exact) rank++;
+    return qwRank(qWin, rank == 0 ? 0 : rank - 1);
+}
@@ -0,0 +1,61 @@
+/* Roberto Masocco
+ * Creation Date: 18/10/2026
+ * Latest Version: 18/10/2026
+ * ----------------------------------------------------------------------------
+ * This file contains type definitions and declarations for the Quantile
+ * Window data structure. See the source file for a brief description of what
+ * each function does.
+ * A quantile window holds the last N numeric samples pushed into it, keeping
+ * them both in arrival order, inside a Circular Buffer, and in value order,
+ * inside a size-augmented randomized search tree (a treap).
+ * The Circular Buffer tells which sample must be evicted when a new one
+ * arrives and the window is full, while the tree allows to find the k-th
+ * smallest sample, hence any quantile, without copying or sorting anything.
+ * Pushes (with evictions) and queries take O(log N) expected time.
+ * All the memory needed is allocated upon creation, so pushes never allocate.
+ */
+/* This code is released under the MIT license.
+ * See the attached LICENSE file.
+ */
+
+#ifndef WINDOWQUANTILE_H
+#define WINDOWQUANTILE_H
+
+#include <sys/types.h>
+
+#include "../CircularBuffer/CircularBuffer.h"
+
+/* A tree node holds a sample, together with its arrival number (which breaks
+ * ties between equal values), its random priority and the size of the subtree
+ * rooted at it.
+ * The Circular Buffer stores pointers to these nodes.
+ */
+typedef struct _QWNode {
+    double value;
+    ulong _seq;
+    ulong _prio;
+    ulong _size;
+    struct _QWNode *_left;
+    struct _QWNode *_right;
+} QWNode;
+
+/* A quantile window is made of the Circular Buffer that keeps the samples in
+ * arrival order, a pool of tree nodes, the root of the tree and a couple of
+ * counters used to order equal samples and to generate priorities.
+ */
+typedef struct {
+    CircBuffer *_window;
+    QWNode *_nodes;
+    QWNode *_root;
+    ulong _seq;
+    ulong _rngState;
+} QuantileWindow;
+
+QuantileWindow *createQWindow(ulong winSize);
+void deleteQWindow(QuantileWindow *qWin);
+int qwPush(QuantileWindow *qWin, double sample);
+ulong qwCount(QuantileWindow *qWin);
+double qwRank(QuantileWindow *qWin, ulong k);
+double qwQuantile(QuantileWindow *qWin, double q);
+
+#endif